@@ -0,0 +1,1047 @@
+/* See LICENSE for copyright details */
+
+/* NOTE: headless conversion: one colour literal per line on stdin (or a file), one
+ * converted colour per line on stdout. Input is either hex (RRGGBB or RRGGBBAA with an
+ * optional '#' or '0x') or 3-4 floats (RGB[A], separated by spaces or commas) in the
+ * same forms -h and -r/-g/-b/-a accept. Blank lines are passed through; bad lines are reported on stderr
+ * and written as blank lines so output stays line aligned.
+ *
+ * Input is read in blocks which are cut into newline aligned tasks. Each worker thread
+ * owns a contiguous range of a block's tasks and takes from its front; once that runs
+ * out it steals from the back of the other ranges. Every task formats into its own
+ * Stream and the main thread writes them out in order, working on tasks itself while
+ * it waits. The next block is read while the current one is being converted.
+ *
+ * Pipelines can skip text entirely: input starting with a BatchBinaryHeader is read as
+ * packed RGBA8 (pack_rl_colour order, stored little endian), packed HSV8 or HSV16 (see
+ * util.c) or as blocks of f32 SoA channels in any ColourKind, and any of them can be
+ * produced as output. Conversions between the packed formats stay in integer lanes.
+ * Blank and invalid text lines have no binary representation and are dropped from
+ * binary output.
+ *
+ * Regular files are mapped instead of read so tasks parse straight out of the page
+ * cache. Finished tasks are appended to one buffered stdout Stream; a full task is
+ * larger than its buffer so it goes out uncopied in one gathered write. */
+#if !OS_WINDOWS
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#define BATCH_CHUNK_COLOURS   4096
+#define BATCH_BLOCK_SIZE      MB(32)
+#define BATCH_TASK_SIZE       KB(128)
+#define BATCH_WORKER_TASKS    8
+#define BATCH_MAX_THREADS     64
+#define BATCH_REPORTED_ERRORS 16
+#define BATCH_OUTPUT_SIZE     KB(64)
+
+/* NOTE: worst case output for a task. The longest output line is 4 floats of at most
+ * 15 characters plus separators (64 bytes) and the shortest line which produces one is
+ * "1 1 1\n". A task may run past BATCH_TASK_SIZE to finish its last line. */
+#define BATCH_MAX_OUTPUT_LINE 64
+#define BATCH_MIN_COLOUR_LINE 6
+#define BATCH_TASK_OUTPUT_SIZE \
+	((BATCH_TASK_SIZE / BATCH_MIN_COLOUR_LINE + 2) * BATCH_MAX_OUTPUT_LINE)
+/* NOTE: binary tasks are cut by colour count so they stay inside the same bound */
+#define BATCH_TASK_COLOURS    (BATCH_TASK_SIZE / BATCH_MIN_COLOUR_LINE)
+
+typedef enum {
+	BatchFormat_Text,
+	BatchFormat_RGBA8,
+	BatchFormat_F32,
+	BatchFormat_HSV8,
+	BatchFormat_HSV16,
+} BatchFormat;
+
+/* NOTE: binary streams start with this header, everything little endian. RGBA8 and HSV8
+ * are followed by packed u32s and HSV16 by packed u64s until the end of the stream. F32
+ * is followed by blocks of
+ * at most block_colours colours: a BatchBinaryBlock then count f32s for each of the
+ * x, y, z and w channels of kind. */
+#define BATCH_BINARY_MAGIC   0x62635043u /* "CPcb" */
+#define BATCH_BINARY_VERSION 1
+typedef struct {
+	u32 magic;
+	u8  version;
+	u8  format;
+	u8  kind;
+	u8  reserved;
+	u32 block_colours;
+} BatchBinaryHeader;
+static_assert(sizeof(BatchBinaryHeader) == 12, "BatchBinaryHeader must be packed");
+
+typedef struct {
+	u32 count;
+	u32 reserved;
+} BatchBinaryBlock;
+
+typedef struct {
+	BatchFormat format;
+	ColourKind  kind;
+	b32         hex;
+} BatchOutput;
+
+typedef enum {
+	BatchLineKind_Blank,
+	BatchLineKind_Colour,
+	BatchLineKind_Invalid,
+} BatchLineKind;
+
+typedef struct {
+	alignas(64) f32 x[BATCH_CHUNK_COLOURS];
+	alignas(64) f32 y[BATCH_CHUNK_COLOURS];
+	alignas(64) f32 z[BATCH_CHUNK_COLOURS];
+	alignas(64) f32 w[BATCH_CHUNK_COLOURS];
+	u8  kinds[BATCH_CHUNK_COLOURS];
+	s32 count;
+	/* NOTE: set when some colour didn't come from 8 bit input (hex or packed). Otherwise
+	 * the channels are exact c / 255 and can be linearized through the lookup table */
+	b32 fractional;
+} BatchChunk;
+
+typedef struct {
+	str8   input;
+	Stream out;
+	u64    lines;
+	u32    invalid_count;
+	u32    invalid_lines[BATCH_REPORTED_ERRORS];
+	str8   invalid_text[BATCH_REPORTED_ERRORS];
+	u32    done;
+} BatchTask;
+
+/* NOTE: [head, tail) of the tasks owned by a worker packed as head | tail << 32 so that
+ * both ends can be claimed with a single CAS */
+typedef struct {
+	alignas(64) u64 range;
+} BatchQueue;
+
+typedef struct {
+	BatchOutput output;
+	Stream      out;
+
+	BatchFormat input_format;
+	ColourKind  input_kind;
+	u32         input_block_colours;
+
+	BatchTask  *tasks;
+	u32         task_count;
+	u32         task_capacity;
+
+	BatchChunk *chunks;
+	BatchQueue  queues[BATCH_MAX_THREADS];
+	u32         worker_count;
+
+	#if !OS_WINDOWS
+	pthread_t       threads[BATCH_MAX_THREADS];
+	pthread_mutex_t lock;
+	pthread_cond_t  work_ready;
+	pthread_cond_t  task_done;
+	#endif
+	u32 generation;
+	b32 quit;
+} BatchPool;
+
+typedef struct {
+	BatchPool *pool;
+	u32        index;
+} BatchWorker;
+
+#define BATCH_KIND_NAME(_, kind, name, hub) [ColourKind_##kind] = str8_comp(#name),
+read_only global str8 batch_kind_names[ColourKind_Last] = {
+	COLOUR_KIND_LIST(BATCH_KIND_NAME, _)
+};
+#undef BATCH_KIND_NAME
+
+/* NOTE: hex, a kind name (rgb, hsv, ...), rgba8, hsv8, hsv16 or a kind name with -f32
+ * appended; returns 0 if name isn't a valid output */
+function b32
+batch_output_from_str8(str8 name, BatchOutput *output)
+{
+	b32 result = 1;
+	*output = (BatchOutput){.format = BatchFormat_Text, .kind = ColourKind_RGB};
+	if (str8_equal(name, str8("hex"))) {
+		output->hex = 1;
+	} else if (str8_equal(name, str8("rgba8"))) {
+		output->format = BatchFormat_RGBA8;
+	} else if (str8_equal(name, str8("hsv8"))) {
+		output->format = BatchFormat_HSV8;
+	} else if (str8_equal(name, str8("hsv16"))) {
+		output->format = BatchFormat_HSV16;
+	} else {
+		str8 suffix = str8("-f32");
+		if (name.length > suffix.length &&
+		    str8_equal((str8){.length = suffix.length, .data = name.data + name.length - suffix.length}, suffix))
+		{
+			output->format  = BatchFormat_F32;
+			name.length    -= suffix.length;
+		}
+
+		result = 0;
+		for (u32 i = 0; !result && i < ColourKind_Last; i++) {
+			if (str8_equal(name, batch_kind_names[i])) {
+				output->kind = (ColourKind)i;
+				result       = 1;
+			}
+		}
+	}
+	return result;
+}
+
+/* NOTE: bytes per colour of the packed binary formats, 0 for the others */
+function s64
+batch_packed_size(BatchFormat format)
+{
+	s64 result = 0;
+	switch (format) {
+	case BatchFormat_RGBA8: result = sizeof(u32); break;
+	case BatchFormat_HSV8:  result = sizeof(u32); break;
+	case BatchFormat_HSV16: result = sizeof(u64); break;
+	default: break;
+	}
+	return result;
+}
+
+function s64
+batch_f32_block_size(u32 count)
+{
+	return (s64)sizeof(BatchBinaryBlock) + 4 * (s64)sizeof(f32) * count;
+}
+
+/* NOTE: returns the size of the binary header at the start of data (0 for text) or -1
+ * for a binary stream this build can't read */
+function s64
+batch_read_header(BatchPool *pool, str8 data)
+{
+	s64 result = 0;
+	pool->input_format = BatchFormat_Text;
+	pool->input_kind   = ColourKind_RGB;
+	if (data.length >= (s64)sizeof(BatchBinaryHeader) && load_u32_unaligned(data.data) == BATCH_BINARY_MAGIC) {
+		BatchBinaryHeader header;
+		memory_copy(&header, data.data, sizeof(header));
+		result = -1;
+		if (header.version == BATCH_BINARY_VERSION) {
+			if (batch_packed_size((BatchFormat)header.format)) {
+				pool->input_format = (BatchFormat)header.format;
+				result = sizeof(header);
+			}
+			if (header.format == BatchFormat_F32 && header.kind < ColourKind_Last &&
+			    Between(header.block_colours, 1, BATCH_CHUNK_COLOURS))
+			{
+				pool->input_format        = BatchFormat_F32;
+				pool->input_kind          = header.kind;
+				pool->input_block_colours = header.block_colours;
+				result = sizeof(header);
+			}
+		}
+	}
+	return result;
+}
+
+/* NOTE: returns how much of data is made of complete records (lines, colours or blocks)
+ * or -1 if an f32 block header is corrupt */
+function s64
+batch_complete_records(BatchPool *pool, str8 data)
+{
+	s64 result = 0;
+	switch (pool->input_format) {
+	case BatchFormat_Text:{
+		result = data.length;
+		while (result > 0 && data.data[result - 1] != '\n') result--;
+	}break;
+	case BatchFormat_RGBA8:
+	case BatchFormat_HSV8:
+	case BatchFormat_HSV16:{
+		result = data.length - data.length % batch_packed_size(pool->input_format);
+	}break;
+	case BatchFormat_F32:{
+		while (result >= 0 && result + (s64)sizeof(BatchBinaryBlock) <= data.length) {
+			u32 count = load_u32_unaligned(data.data + result);
+			if (count > pool->input_block_colours) {
+				result = -1;
+			} else {
+				if (result + batch_f32_block_size(count) > data.length) break;
+				result += batch_f32_block_size(count);
+			}
+		}
+	}break;
+	}
+	return result;
+}
+
+function b32
+batch_is_separator(u8 c)
+{
+	return c == ' ' || c == '\t' || c == ',' || c == '\r';
+}
+
+function str8
+batch_skip_separators(str8 s)
+{
+	while (s.length > 0 && batch_is_separator(s.data[0])) {
+		s.data++;
+		s.length--;
+	}
+	return s;
+}
+
+/* NOTE: eight_bit is set for hex literals */
+function BatchLineKind
+batch_parse_line(str8 line, v4 *rgba, b32 *eight_bit)
+{
+	*eight_bit = 0;
+	line = batch_skip_separators(line);
+	while (line.length > 0 && batch_is_separator(line.data[line.length - 1]))
+		line.length--;
+
+	if (line.length == 0)
+		return BatchLineKind_Blank;
+
+	b32 single_token = 1;
+	for (s64 i = 0; single_token && i < line.length; i++)
+		single_token = !batch_is_separator(line.data[i]);
+
+	BatchLineKind result = BatchLineKind_Invalid;
+	if (single_token) {
+		if (line.data[0] == '#') {
+			line.data++;
+			line.length--;
+		}
+		s64 digits = line.length;
+		if (digits > 2 && line.data[0] == '0' && (line.data[1] == 'x' || line.data[1] == 'X'))
+			digits -= 2;
+
+		NumberConversion number = integer_from_str8(line, 1);
+		if (number.result == NumberConversionResult_Success && number.unparsed.length == 0 &&
+		    (digits == 6 || digits == 8))
+		{
+			u32 packed = (u32)number.U64;
+			if (digits == 6) packed = packed << 8 | 0xFF;
+			*rgba      = normalize_colour(packed);
+			*eight_bit = 1;
+			result     = BatchLineKind_Colour;
+		}
+	} else {
+		v4  value = {.a = 1};
+		s32 count = 0;
+		for (; line.length > 0 && count < 4; count++) {
+			NumberConversion number = number_from_str8(line);
+			if (number.result != NumberConversionResult_Success)
+				break;
+
+			f64 f;
+			if (number.kind == NumberConversionKind_Float) f = number.F64;
+			else                                           f = (f64)number.S64;
+			value.E[count] = Clamp01(f);
+
+			line = batch_skip_separators(number.unparsed);
+		}
+		if (line.length == 0 && count >= 3) {
+			*rgba  = value;
+			result = BatchLineKind_Colour;
+		}
+	}
+
+	return result;
+}
+
+/* NOTE: round rather than truncate so that 8 bit input comes back unchanged. linear
+ * channels are encoded through the lookup table; alpha never is */
+function u32
+batch_pack_rgba8(BatchChunk *chunk, s32 i, b32 linear)
+{
+	u32 result = (u32)(Clamp01(chunk->w[i]) * 255 + 0.5f);
+	if (linear) {
+		result |= linear_to_srgb8(chunk->x[i]) << 24 |
+		          linear_to_srgb8(chunk->y[i]) << 16 |
+		          linear_to_srgb8(chunk->z[i]) <<  8;
+	} else {
+		result |= (u32)(Clamp01(chunk->x[i]) * 255 + 0.5f) << 24 |
+		          (u32)(Clamp01(chunk->y[i]) * 255 + 0.5f) << 16 |
+		          (u32)(Clamp01(chunk->z[i]) * 255 + 0.5f) <<  8;
+	}
+	return result;
+}
+
+/* NOTE: count packed colours (at most BATCH_CHUNK_COLOURS) to RGBA8; data may be
+ * unaligned */
+function void
+batch_rgba8_from_packed(u32 *rgba, u8 *data, s64 count, BatchFormat format)
+{
+	switch (format) {
+	case BatchFormat_RGBA8:{
+		memory_copy(rgba, data, count * (s64)sizeof(u32));
+	}break;
+	case BatchFormat_HSV8:{
+		alignas(64) u32 hsv[BATCH_CHUNK_COLOURS];
+		memory_copy(hsv, data, count * (s64)sizeof(*hsv));
+		rgba8_from_hsv8_buffer(rgba, hsv, count);
+	}break;
+	case BatchFormat_HSV16:{
+		alignas(64) u64 hsv[BATCH_CHUNK_COLOURS];
+		memory_copy(hsv, data, count * (s64)sizeof(*hsv));
+		rgba8_from_hsv16_buffer(rgba, hsv, count);
+	}break;
+	default:{ assert(0); }break;
+	}
+}
+
+/* NOTE: appends count RGBA8 colours (at most BATCH_CHUNK_COLOURS) in a packed format */
+function void
+batch_append_packed(Stream *s, BatchFormat format, u32 *rgba, s64 count)
+{
+	switch (format) {
+	case BatchFormat_RGBA8:{
+		stream_append(s, rgba, count * (s64)sizeof(u32));
+	}break;
+	case BatchFormat_HSV8:{
+		alignas(64) u32 hsv[BATCH_CHUNK_COLOURS];
+		hsv8_from_rgba8_buffer(hsv, rgba, count);
+		stream_append(s, hsv, count * (s64)sizeof(*hsv));
+	}break;
+	case BatchFormat_HSV16:{
+		alignas(64) u64 hsv[BATCH_CHUNK_COLOURS];
+		hsv16_from_rgba8_buffer(hsv, rgba, count);
+		stream_append(s, hsv, count * (s64)sizeof(*hsv));
+	}break;
+	default:{ assert(0); }break;
+	}
+}
+
+function void
+batch_emit_chunk(BatchPool *pool, BatchChunk *chunk, Stream *s)
+{
+	BatchOutput *output = &pool->output;
+
+	/* NOTE: 8 bit data on either side goes through the sRGB lookup tables when the other
+	 * side is a kind defined on linear light. 8 bit output is always RGB. */
+	colour_soa_kernel_fn *from_linear = linear_to_colour_table[output->kind];
+	colour_soa_kernel_fn *to_linear   = colour_to_linear_table[pool->input_kind];
+	b32 eight_bit_output = output->hex || batch_packed_size(output->format);
+	b32 linear = 0;
+	if (pool->input_kind == ColourKind_RGB && !chunk->fractional && from_linear) {
+		linear_from_srgb8_soa(chunk->x, chunk->y, chunk->z, chunk->count);
+		from_linear(chunk->x, chunk->y, chunk->z, chunk->count);
+	} else if (eight_bit_output && to_linear) {
+		to_linear(chunk->x, chunk->y, chunk->z, chunk->count);
+		linear = 1;
+	} else {
+		convert_colour_soa(chunk->x, chunk->y, chunk->z, chunk->count, pool->input_kind, output->kind);
+	}
+
+	switch (output->format) {
+	case BatchFormat_Text:{
+		for (s32 i = 0; i < chunk->count; i++) {
+			if (chunk->kinds[i] == BatchLineKind_Colour) {
+				if (output->hex) {
+					stream_append_hex_u32(s, batch_pack_rgba8(chunk, i, linear));
+				} else {
+					stream_append_f32_shortest(s, chunk->x[i]);
+					stream_append_byte(s, ' ');
+					stream_append_f32_shortest(s, chunk->y[i]);
+					stream_append_byte(s, ' ');
+					stream_append_f32_shortest(s, chunk->z[i]);
+					stream_append_byte(s, ' ');
+					stream_append_f32_shortest(s, chunk->w[i]);
+				}
+			}
+			stream_append_byte(s, '\n');
+		}
+	}break;
+	case BatchFormat_RGBA8:
+	case BatchFormat_HSV8:
+	case BatchFormat_HSV16:{
+		alignas(64) u32 packed[BATCH_CHUNK_COLOURS];
+		for (s32 i = 0; i < chunk->count; i++)
+			packed[i] = batch_pack_rgba8(chunk, i, linear);
+		batch_append_packed(s, output->format, packed, chunk->count);
+	}break;
+	case BatchFormat_F32:{
+		if (chunk->count) {
+			BatchBinaryBlock block = {.count = (u32)chunk->count};
+			stream_append(s, &block, sizeof(block));
+			stream_append(s, chunk->x, chunk->count * (s64)sizeof(f32));
+			stream_append(s, chunk->y, chunk->count * (s64)sizeof(f32));
+			stream_append(s, chunk->z, chunk->count * (s64)sizeof(f32));
+			stream_append(s, chunk->w, chunk->count * (s64)sizeof(f32));
+		}
+	}break;
+	}
+	chunk->count      = 0;
+	chunk->fractional = 0;
+}
+
+/* NOTE: appends to task->out; the task's counters must start out cleared */
+function void
+batch_run_task(BatchPool *pool, BatchChunk *chunk, BatchTask *task)
+{
+	str8 input = task->input;
+	switch (pool->input_format) {
+	case BatchFormat_Text:{
+		b32 keep_all = pool->output.format == BatchFormat_Text;
+		while (input.length > 0) {
+			s64 length = 0;
+			while (length < input.length && input.data[length] != '\n')
+				length++;
+			str8 line = {.length = length, .data = input.data};
+			input.data   += Min(length + 1, input.length);
+			input.length -= Min(length + 1, input.length);
+
+			v4  rgba = {0};
+			b32 eight_bit;
+			BatchLineKind kind = batch_parse_line(line, &rgba, &eight_bit);
+			if (kind == BatchLineKind_Invalid) {
+				if (task->invalid_count < BATCH_REPORTED_ERRORS) {
+					task->invalid_lines[task->invalid_count] = (u32)task->lines;
+					task->invalid_text[task->invalid_count]  = line;
+				}
+				task->invalid_count++;
+			}
+			task->lines++;
+
+			if (keep_all || kind == BatchLineKind_Colour) {
+				chunk->fractional |= kind == BatchLineKind_Colour && !eight_bit;
+				s32 i = chunk->count++;
+				chunk->kinds[i] = (u8)kind;
+				chunk->x[i]     = rgba.r;
+				chunk->y[i]     = rgba.g;
+				chunk->z[i]     = rgba.b;
+				chunk->w[i]     = rgba.a;
+			}
+
+			if (chunk->count == BATCH_CHUNK_COLOURS)
+				batch_emit_chunk(pool, chunk, &task->out);
+		}
+	}break;
+	case BatchFormat_RGBA8:
+	case BatchFormat_HSV8:
+	case BatchFormat_HSV16:{
+		s64 size  = batch_packed_size(pool->input_format);
+		s64 count = input.length / size;
+		task->lines = (u64)count;
+		if (pool->output.format == pool->input_format) {
+			/* NOTE: packed formats have a single encoding so this is a straight copy */
+			stream_append(&task->out, input.data, input.length);
+		} else {
+			alignas(64) u32 rgba[BATCH_CHUNK_COLOURS];
+			for (s64 base = 0; base < count; base += BATCH_CHUNK_COLOURS) {
+				s32 n = (s32)Min(count - base, BATCH_CHUNK_COLOURS);
+				batch_rgba8_from_packed(rgba, input.data + base * size, n, pool->input_format);
+				if (batch_packed_size(pool->output.format)) {
+					batch_append_packed(&task->out, pool->output.format, rgba, n);
+				} else {
+					for (s32 i = 0; i < n; i++) {
+						chunk->kinds[i] = BatchLineKind_Colour;
+						chunk->x[i]     = ((rgba[i] >> 24) & 0xFF) / 255.0f;
+						chunk->y[i]     = ((rgba[i] >> 16) & 0xFF) / 255.0f;
+						chunk->z[i]     = ((rgba[i] >>  8) & 0xFF) / 255.0f;
+						chunk->w[i]     = ((rgba[i] >>  0) & 0xFF) / 255.0f;
+					}
+					chunk->count = n;
+					batch_emit_chunk(pool, chunk, &task->out);
+				}
+			}
+		}
+	}break;
+	case BatchFormat_F32:{
+		while (input.length > 0) {
+			s32 count = (s32)load_u32_unaligned(input.data);
+			f32 *x = (f32 *)(input.data + sizeof(BatchBinaryBlock));
+			if (chunk->count + count > BATCH_CHUNK_COLOURS)
+				batch_emit_chunk(pool, chunk, &task->out);
+
+			s32 base = chunk->count;
+			chunk->fractional = 1;
+			memory_copy(chunk->x + base, x + 0 * count, count * (s64)sizeof(f32));
+			memory_copy(chunk->y + base, x + 1 * count, count * (s64)sizeof(f32));
+			memory_copy(chunk->z + base, x + 2 * count, count * (s64)sizeof(f32));
+			memory_copy(chunk->w + base, x + 3 * count, count * (s64)sizeof(f32));
+			for (s32 i = 0; i < count; i++)
+				chunk->kinds[base + i] = BatchLineKind_Colour;
+			chunk->count += count;
+			task->lines  += (u64)count;
+
+			input.data   += batch_f32_block_size((u32)count);
+			input.length -= batch_f32_block_size((u32)count);
+		}
+	}break;
+	}
+	batch_emit_chunk(pool, chunk, &task->out);
+}
+
+/* NOTE: returns the index of a task to run or -1 when every queue is empty */
+function s64
+batch_take_task(BatchPool *pool, u32 worker)
+{
+	s64 result = -1;
+
+	u64 *own   = &pool->queues[worker].range;
+	u64  range = atomic_load_u64(own);
+	while (result < 0 && (u32)range < (u32)(range >> 32)) {
+		if (atomic_cas_u64(own, &range, range + 1))
+			result = (u32)range;
+	}
+
+	for (u32 i = 1; result < 0 && i < pool->worker_count; i++) {
+		u64 *victim = &pool->queues[(worker + i) % pool->worker_count].range;
+		range = atomic_load_u64(victim);
+		while (result < 0 && (u32)range < (u32)(range >> 32)) {
+			u64 tail = (range >> 32) - 1;
+			if (atomic_cas_u64(victim, &range, tail << 32 | (u32)range))
+				result = (s64)tail;
+		}
+	}
+
+	return result;
+}
+
+#if !OS_WINDOWS
+function void *
+batch_worker_thread(void *arg)
+{
+	BatchWorker *worker = arg;
+	BatchPool   *pool   = worker->pool;
+	BatchChunk  *chunk  = pool->chunks + worker->index;
+
+	u32 generation = 0;
+	for (;;) {
+		pthread_mutex_lock(&pool->lock);
+		while (pool->generation == generation && !pool->quit)
+			pthread_cond_wait(&pool->work_ready, &pool->lock);
+		generation = pool->generation;
+		b32 quit   = pool->quit;
+		pthread_mutex_unlock(&pool->lock);
+		if (quit) break;
+
+		for (s64 index; (index = batch_take_task(pool, worker->index)) >= 0;) {
+			batch_run_task(pool, chunk, pool->tasks + index);
+			atomic_store_u32(&pool->tasks[index].done, 1);
+
+			pthread_mutex_lock(&pool->lock);
+			pthread_cond_broadcast(&pool->task_done);
+			pthread_mutex_unlock(&pool->lock);
+		}
+	}
+
+	return 0;
+}
+#endif
+
+/* NOTE: input must end on a record boundary. At most task_capacity tasks are cut from
+ * it per round; returns how much of input they cover. Tasks (and their output buffers)
+ * are only rewritten here, after the previous round's tasks have all been written out,
+ * and are published through the queues so a worker which is still looking for work can
+ * safely pick them up. */
+function s64
+batch_dispatch(BatchPool *pool, str8 input)
+{
+	s64 result = 0;
+	u32 count  = 0;
+	while (input.length > 0 && count < pool->task_capacity) {
+		s64 length = 0;
+		switch (pool->input_format) {
+		case BatchFormat_Text:{
+			length = Min(input.length, (s64)BATCH_TASK_SIZE);
+			while (length < input.length && input.data[length - 1] != '\n')
+				length++;
+		}break;
+		case BatchFormat_RGBA8:
+		case BatchFormat_HSV8:
+		case BatchFormat_HSV16:{
+			length = Min(input.length, (s64)BATCH_TASK_COLOURS * batch_packed_size(pool->input_format));
+		}break;
+		case BatchFormat_F32:{
+			u64 colours = 0;
+			while (length < input.length) {
+				u32 block = load_u32_unaligned(input.data + length);
+				if (length > 0 && colours + block > BATCH_TASK_COLOURS) break;
+				colours += block;
+				length  += batch_f32_block_size(block);
+			}
+		}break;
+		}
+
+		BatchTask *task = pool->tasks + count++;
+		task->input         = (str8){.length = length, .data = input.data};
+		task->out.widx      = 0;
+		task->out.errors    = 0;
+		task->lines         = 0;
+		task->invalid_count = 0;
+		task->done          = 0;
+
+		input.data   += length;
+		input.length -= length;
+		result       += length;
+	}
+	pool->task_count = count;
+
+	for (u32 i = 0; i < pool->worker_count; i++) {
+		u64 head = (u64)count *  i      / pool->worker_count;
+		u64 tail = (u64)count * (i + 1) / pool->worker_count;
+		atomic_store_u64(&pool->queues[i].range, tail << 32 | head);
+	}
+
+	#if !OS_WINDOWS
+	if (pool->worker_count > 1) {
+		pthread_mutex_lock(&pool->lock);
+		pool->generation++;
+		pthread_cond_broadcast(&pool->work_ready);
+		pthread_mutex_unlock(&pool->lock);
+	}
+	#endif
+
+	return result;
+}
+
+/* NOTE: writes the dispatched tasks in order; returns 1 if any line was invalid */
+function b32
+batch_finish(BatchPool *pool, u64 *line)
+{
+	b32 result = 0;
+	for (u32 i = 0; i < pool->task_count; i++) {
+		BatchTask *task = pool->tasks + i;
+		while (!atomic_load_u32(&task->done)) {
+			s64 index = batch_take_task(pool, 0);
+			if (index >= 0) {
+				batch_run_task(pool, pool->chunks, pool->tasks + index);
+				atomic_store_u32(&pool->tasks[index].done, 1);
+			} else {
+				#if !OS_WINDOWS
+				pthread_mutex_lock(&pool->lock);
+				while (!atomic_load_u32(&task->done))
+					pthread_cond_wait(&pool->task_done, &pool->lock);
+				pthread_mutex_unlock(&pool->lock);
+				#endif
+			}
+		}
+
+		stream_append(&pool->out, task->out.data, task->out.widx);
+
+		u32 reported = Min(task->invalid_count, BATCH_REPORTED_ERRORS);
+		for (u32 j = 0; j < reported; j++) {
+			str8 text = task->invalid_text[j];
+			fprintf(stderr, "batch: line %llu: invalid colour literal: %.*s\n",
+			        (unsigned long long)(*line + task->invalid_lines[j] + 1),
+			        (s32)Min(text.length, 64), text.data);
+		}
+		if (task->invalid_count > reported) {
+			fprintf(stderr, "batch: %u more invalid lines in lines %llu-%llu\n",
+			        task->invalid_count - reported,
+			        (unsigned long long)(*line + 1), (unsigned long long)(*line + task->lines));
+		}
+
+		result |= task->invalid_count > 0 || task->out.errors;
+		*line  += task->lines;
+	}
+	return result;
+}
+
+/* NOTE: task output is only held until its round is written out, so the buffers are
+ * sized for one round of BATCH_WORKER_TASKS per worker or, for a smaller input, for as
+ * many tasks as it can be cut into. Binary tasks are the shortest per colour. */
+function b32
+batch_reserve_tasks(BatchPool *pool, s64 input_size)
+{
+	u64 count = (u64)pool->worker_count * BATCH_WORKER_TASKS;
+	count = Min(count, (u64)input_size / (BATCH_TASK_COLOURS * sizeof(u32)) + 1);
+
+	u8 *output  = malloc(count * BATCH_TASK_OUTPUT_SIZE);
+	pool->tasks = calloc(count, sizeof(*pool->tasks));
+	b32 result  = output && pool->tasks;
+	if (result) {
+		pool->task_capacity = (u32)count;
+		for (u64 i = 0; i < count; i++) {
+			pool->tasks[i].out.data = output + i * BATCH_TASK_OUTPUT_SIZE;
+			pool->tasks[i].out.cap  = BATCH_TASK_OUTPUT_SIZE;
+		}
+	} else {
+		fprintf(stderr, "batch: failed to allocate memory\n");
+	}
+	return result;
+}
+
+function s64
+batch_fill(FILE *input, u8 *buffer, s64 filled, s64 size)
+{
+	s64 read;
+	while (filled < size && (read = (s64)fread(buffer + filled, 1, (u64)(size - filled), input)) > 0)
+		filled += read;
+	return filled;
+}
+
+function b32
+batch_convert_file(BatchPool *pool, FILE *input, u64 *line)
+{
+	u8 *blocks[2] = {malloc(BATCH_BLOCK_SIZE), malloc(BATCH_BLOCK_SIZE)};
+	if (!blocks[0] || !blocks[1]) {
+		fprintf(stderr, "batch: failed to allocate memory\n");
+		return 1;
+	}
+	if (!batch_reserve_tasks(pool, BATCH_BLOCK_SIZE))
+		return 1;
+
+	b32 errors   = 0;
+	u32 current  = 0;
+	b32 skipping = 0;
+	s64 filled   = batch_fill(input, blocks[current], 0, BATCH_BLOCK_SIZE);
+	s64 begin    = batch_read_header(pool, (str8){.length = filled, .data = blocks[current]});
+	if (begin < 0) {
+		fprintf(stderr, "batch: unsupported binary input\n");
+		errors = 1;
+		filled = begin = 0;
+	}
+
+	while (filled > begin) {
+		str8 data = {.length = filled - begin, .data = blocks[current] + begin};
+		b32  eof  = filled < (s64)BATCH_BLOCK_SIZE;
+		b32  text = pool->input_format == BatchFormat_Text;
+
+		/* NOTE: hold back a partial last record for the next block */
+		s64 used = batch_complete_records(pool, data);
+		if (used < 0) {
+			fprintf(stderr, "batch: corrupt f32 block\n");
+			errors = 1;
+			break;
+		}
+
+		b32 overlong = 0;
+		if (eof && used < data.length) {
+			if (text) {
+				used = data.length;
+			} else {
+				fprintf(stderr, "batch: truncated binary input\n");
+				errors = 1;
+			}
+		} else if (used == 0) {
+			used     = data.length;
+			overlong = 1;
+		}
+
+		/* NOTE: a line longer than a whole block can't be a colour. It is converted (and
+		 * reported) once as a truncated line and the remainder is dropped. */
+		s64 start = 0;
+		if (skipping) {
+			while (start < used && data.data[start] != '\n') start++;
+			skipping = start == used;
+			start    = Min(start + 1, used);
+		}
+		if (!skipping && overlong)
+			skipping = 1;
+
+		/* NOTE: the next block is read while the block's last round is converted */
+		str8 round = {.length = used - start, .data = data.data + start};
+		do {
+			s64 taken = batch_dispatch(pool, round);
+			round.data   += taken;
+			round.length -= taken;
+
+			if (round.length == 0) {
+				current = !current;
+				memory_copy(blocks[current], data.data + used, data.length - used);
+				filled = eof ? 0 : batch_fill(input, blocks[current], data.length - used, BATCH_BLOCK_SIZE);
+				begin  = 0;
+			}
+
+			errors |= batch_finish(pool, line);
+		} while (round.length > 0);
+	}
+
+	if (ferror(input)) {
+		fprintf(stderr, "batch: failed to read input\n");
+		errors = 1;
+	}
+
+	free(blocks[0]);
+	free(blocks[1]);
+
+	return errors;
+}
+
+/* NOTE: the mapping is walked in blocks which end on a record boundary; text blocks are
+ * extended to the next line so nothing is copied and there is no limit on line length */
+function b32
+batch_convert_mapping(BatchPool *pool, str8 input, u64 *line)
+{
+	b32 errors = 0;
+	s64 header = batch_read_header(pool, input);
+	if (header < 0) {
+		fprintf(stderr, "batch: unsupported binary input\n");
+		errors = 1;
+		header = input.length;
+	}
+	input.data   += header;
+	input.length -= header;
+
+	if (input.length > 0 && !batch_reserve_tasks(pool, Min(input.length, (s64)BATCH_BLOCK_SIZE)))
+		return 1;
+
+	while (input.length > 0) {
+		s64 length = Min(input.length, (s64)BATCH_BLOCK_SIZE);
+		if (pool->input_format == BatchFormat_Text) {
+			while (length < input.length && input.data[length - 1] != '\n')
+				length++;
+		} else {
+			length = batch_complete_records(pool, (str8){.length = length, .data = input.data});
+			if (length <= 0) {
+				if (length < 0) fprintf(stderr, "batch: corrupt f32 block\n");
+				else            fprintf(stderr, "batch: truncated binary input\n");
+				errors = 1;
+				break;
+			}
+		}
+
+		for (s64 taken = 0; taken < length;) {
+			taken  += batch_dispatch(pool, (str8){.length = length - taken, .data = input.data + taken});
+			errors |= batch_finish(pool, line);
+		}
+
+		input.data   += length;
+		input.length -= length;
+	}
+	return errors;
+}
+
+function void
+batch_append_header(Stream *s, BatchOutput output)
+{
+	if (output.format != BatchFormat_Text) {
+		BatchBinaryHeader header = {
+			.magic         = BATCH_BINARY_MAGIC,
+			.version       = BATCH_BINARY_VERSION,
+			.format        = (u8)output.format,
+			.kind          = (u8)output.kind,
+			.block_colours = output.format == BatchFormat_F32 ? BATCH_CHUNK_COLOURS : 0,
+		};
+		stream_append(s, &header, sizeof(header));
+	}
+}
+
+/* NOTE: converts a whole in-memory input on the calling thread, for callers (e.g. the
+ * daemon) which work on small requests. Returns the number of invalid lines or -1 if
+ * the input is binary and malformed; s should be STREAM_GROWABLE (or have room for the
+ * whole output). */
+function s64
+batch_convert_buffer(BatchOutput output, str8 input, BatchChunk *chunk, Stream *s)
+{
+	BatchPool pool = {.output = output, .worker_count = 1};
+
+	s64 result = -1;
+	s64 header = batch_read_header(&pool, input);
+	if (header >= 0) {
+		input.data   += header;
+		input.length -= header;
+		if (pool.input_format == BatchFormat_Text || batch_complete_records(&pool, input) == input.length) {
+			batch_append_header(s, output);
+
+			BatchTask task = {.input = input, .out = *s};
+			chunk->count      = 0;
+			chunk->fractional = 0;
+			batch_run_task(&pool, chunk, &task);
+			*s     = task.out;
+			result = task.invalid_count;
+		}
+	}
+	return result;
+}
+
+/* NOTE: threads == 0 uses every online cpu; path == 0 reads stdin */
+function s32
+run_batch(BatchOutput output, u32 threads, char *path)
+{
+	#if OS_WINDOWS
+	threads = 1;
+	#else
+	if (threads == 0) threads = (u32)Max(sysconf(_SC_NPROCESSORS_ONLN), 1);
+	#endif
+	threads = Min(threads, BATCH_MAX_THREADS);
+
+	u8 out_buffer[BATCH_OUTPUT_SIZE];
+	BatchPool pool = {
+		.output       = output,
+		.out          = {.data = out_buffer, .cap = countof(out_buffer), .fd = 1},
+		.worker_count = threads,
+	};
+
+	pool.chunks = malloc(threads * sizeof(*pool.chunks));
+	if (!pool.chunks) {
+		fprintf(stderr, "batch: failed to allocate memory\n");
+		return 1;
+	}
+	for (u32 i = 0; i < threads; i++) {
+		pool.chunks[i].count      = 0;
+		pool.chunks[i].fractional = 0;
+	}
+
+	#if !OS_WINDOWS
+	BatchWorker workers[BATCH_MAX_THREADS];
+	pthread_mutex_init(&pool.lock, 0);
+	pthread_cond_init(&pool.work_ready, 0);
+	pthread_cond_init(&pool.task_done, 0);
+	for (u32 i = 1; i < pool.worker_count; i++) {
+		workers[i] = (BatchWorker){.pool = &pool, .index = i};
+		if (pthread_create(pool.threads + i, 0, batch_worker_thread, workers + i)) {
+			/* NOTE: run with however many workers could be started */
+			pool.worker_count = i;
+			break;
+		}
+	}
+	#endif
+
+	batch_append_header(&pool.out, output);
+
+	b32 errors = 0;
+	u64 line   = 0;
+	if (!path) {
+		errors = batch_convert_file(&pool, stdin, &line);
+	} else {
+		b32 mapped = 0;
+		#if !OS_WINDOWS
+		s32 fd = open(path, O_RDONLY);
+		struct stat sb;
+		if (fd >= 0 && fstat(fd, &sb) == 0 && S_ISREG(sb.st_mode)) {
+			mapped = 1;
+			if (sb.st_size > 0) {
+				void *data = mmap(0, (u64)sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+				if (data != MAP_FAILED) {
+					madvise(data, (u64)sb.st_size, MADV_SEQUENTIAL);
+					errors = batch_convert_mapping(&pool, (str8){.length = sb.st_size, .data = data}, &line);
+					munmap(data, (u64)sb.st_size);
+				} else {
+					mapped = 0;
+				}
+			}
+		}
+		if (fd >= 0) close(fd);
+		#endif
+
+		/* NOTE: pipes, devices and anything else which can't be mapped */
+		if (!mapped) {
+			FILE *input = fopen(path, "rb");
+			if (input) {
+				errors = batch_convert_file(&pool, input, &line);
+				fclose(input);
+			} else {
+				fprintf(stderr, "batch: failed to open: %s\n", path);
+				errors = 1;
+			}
+		}
+	}
+
+	stream_flush(&pool.out);
+	if (pool.out.errors) {
+		fprintf(stderr, "batch: failed to write stdout\n");
+		errors = 1;
+	}
+
+	#if !OS_WINDOWS
+	pthread_mutex_lock(&pool.lock);
+	pool.quit = 1;
+	pthread_cond_broadcast(&pool.work_ready);
+	pthread_mutex_unlock(&pool.lock);
+	for (u32 i = 1; i < pool.worker_count; i++)
+		pthread_join(pool.threads[i], 0);
+	#endif
+
+	return errors;
+}
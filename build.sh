@@ -4,7 +4,7 @@ version=1.0
 
 cflags=${CFLAGS:-"-march=native -O3"}
 cflags="${cflags} -std=c11 "
-ldflags="${LDFLAGS} -flto -lm"
+ldflags="${LDFLAGS} -flto -lm -pthread"
 
 output="colourpicker"
 
@@ -71,7 +71,9 @@ raylib=out/libraylib.a
 
 cflags="${cflags} -Wall -Wextra -Iout"
 
-if [ ! -s "out/lora_sb_0_inc.h" ] || [ "gen_incs.c" -nt "out/lora_sb_0_inc.h" ]; then
+if [ ! -s "out/lora_sb_inc.h" ] || [ ! -s "out/srgb_lut_inc.h" ] || [ ! -s "out/float_tables_inc.h" ] || \
+   [ ! -s "out/icon_inc.h" ] || [ "gen_incs.c" -nt "out/lora_sb_inc.h" ] || \
+   [ "config.h" -nt "out/lora_sb_inc.h" ]; then
 	${cc} ${cflags} -o gen_incs gen_incs.c ${raylib} ${ldflags} && ./gen_incs
 fi
 
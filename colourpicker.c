@@ -1,4 +1,6 @@
 /* See LICENSE for copyright details */
+/* NOTE: clock_gettime is hidden under -std=c11 */
+#define _GNU_SOURCE
 #include <raylib.h>
 #include <rlgl.h>
 
@@ -6,6 +8,9 @@
 
 global f32 dt_for_frame;
 
+#define TEXT_LAYOUT_MAX_CHARS  64
+#define TEXT_LAYOUT_CACHE_SIZE 64 /* NOTE: must be a power of 2 */
+
 #ifdef _DEBUG
 enum clock_counts {
 	CC_WHOLE_RUN,
@@ -35,13 +40,6 @@ global struct {
 #define END_CYCLE_COUNT(a)
 #endif
 
-function void
-mem_move(u8 *dest, u8 *src, s64 n)
-{
-	if (dest < src) while (n) { *dest++ = *src++; n--; }
-	else            while (n) { n--; dest[n] = src[n]; }
-}
-
 function b32
 point_in_rect(v2 p, Rect r)
 {
@@ -89,50 +87,201 @@ lerp_v4(v4 a, v4 b, f32 t)
 	return result;
 }
 
-function v2
-measure_text(Font font, str8 text)
+/* NOTE: prefix[i] is where glyph i is drawn relative to the start of the text; size is
+ * what measure_text reports (the two only differ for glyphs without an advance) */
+typedef struct {
+	u64 hash;
+	s32 length;
+	u8  text[TEXT_LAYOUT_MAX_CHARS];
+	f32 prefix[TEXT_LAYOUT_MAX_CHARS + 1];
+	v2  size;
+} TextLayout;
+
+/* NOTE: open addressed on the hash of the text; it only holds layouts for one font size
+ * and is emptied when a different font or scale is used or when it fills up */
+typedef struct {
+	TextLayout entries[TEXT_LAYOUT_CACHE_SIZE];
+	u32        used;
+	u32        font_id;
+	f32        font_scale;
+	TextLayout uncached;
+} TextLayoutCache;
+
+global TextLayoutCache text_layout_cache;
+
+function u64
+hash_str8(str8 s)
 {
-	v2 result = {.y = font.baseSize};
+	/* NOTE: FNV-1a */
+	u64 result = 0xCBF29CE484222325ull;
+	for (s64 i = 0; i < s.length; i++)
+		result = (result ^ s.data[i]) * 0x100000001B3ull;
+	/* NOTE: 0 marks an empty slot */
+	return result | 1;
+}
 
-	for (s64 i = 0; i < text.length; i++) {
+function void
+fill_text_layout(TextLayout *tl, SDFFont font, str8 text)
+{
+	Font atlas    = font.atlas;
+	f32  scale    = font.scale;
+	tl->length    = (s32)text.length;
+	tl->size      = (v2){.y = atlas.baseSize * scale};
+	tl->prefix[0] = 0;
+	for (s32 i = 0; i < tl->length; i++) {
 		/* NOTE: assumes font glyphs are ordered (they are in our embedded fonts) */
-		s32 idx   = (s32)text.data[i] - 32;
-		result.x += font.glyphs[idx].advanceX;
-		if (font.glyphs[idx].advanceX == 0)
-			result.x += (font.recs[idx].width + font.glyphs[idx].offsetX);
+		s32 idx = (s32)text.data[i] - 32;
+		f32 advance = atlas.glyphs[idx].advanceX * scale;
+		tl->size.x += advance;
+		if (advance == 0) {
+			tl->size.x += (atlas.recs[idx].width + atlas.glyphs[idx].offsetX) * scale;
+			advance     = atlas.recs[idx].width * scale;
+		}
+		tl->prefix[i + 1] = tl->prefix[i] + advance;
+	}
+}
+
+function TextLayout *
+text_layout(SDFFont font, str8 text)
+{
+	TextLayoutCache *tlc = &text_layout_cache;
+	TextLayout *result   = &tlc->uncached;
+
+	if (text.length <= TEXT_LAYOUT_MAX_CHARS) {
+		if (tlc->font_id != font.atlas.texture.id || tlc->font_scale != font.scale ||
+		    tlc->used == TEXT_LAYOUT_CACHE_SIZE / 2)
+		{
+			memory_clear(tlc->entries, 0, sizeof(tlc->entries));
+			tlc->used       = 0;
+			tlc->font_id    = font.atlas.texture.id;
+			tlc->font_scale = font.scale;
+		}
+
+		u64 hash = hash_str8(text);
+		u32 slot = (u32)hash & (TEXT_LAYOUT_CACHE_SIZE - 1);
+		for (;;) {
+			TextLayout *tl = tlc->entries + slot;
+			if (tl->hash == 0) {
+				tl->hash = hash;
+				memory_copy(tl->text, text.data, text.length);
+				fill_text_layout(tl, font, text);
+				tlc->used++;
+				result = tl;
+				break;
+			}
+			if (tl->hash == hash && tl->length == text.length &&
+			    str8_equal((str8){.length = tl->length, .data = tl->text}, text))
+			{
+				result = tl;
+				break;
+			}
+			slot = (slot + 1) & (TEXT_LAYOUT_CACHE_SIZE - 1);
+		}
+	} else {
+		fill_text_layout(result, font, text);
 	}
 
 	return result;
 }
 
-function void
-draw_text(Font font, str8 text, v2 pos, Color colour)
+function v2
+measure_text(SDFFont font, str8 text)
+{
+	v2 result = text_layout(font, text)->size;
+	return result;
+}
+
+#define TEXT_SHADOW_OFFSET (v2){.x = 1.75, .y = 2}
+#define TEXT_SHADOW_COLOUR (Color){.a = 0xCC}
+
+/* NOTE: destination rect (relative to the text origin) and atlas source rect of a glyph */
+typedef struct {
+	Rect dst;
+	Rect src;
+} GlyphQuad;
+
+/* NOTE: lays out up to countof(quads) glyphs of text; returns how many were consumed and
+ * advances *x past them. dst is scaled, src stays in atlas texels */
+function s64
+layout_glyph_quads(SDFFont font, str8 text, f32 *x, GlyphQuad *quads, s64 quads_count)
 {
-	for (s64 i = 0; i < text.length; i++) {
+	Font atlas = font.atlas;
+	f32  scale = font.scale;
+	s64  count = Min(text.length, quads_count);
+	f32  pad   = atlas.glyphPadding;
+	for (s64 i = 0; i < count; i++) {
 		/* NOTE: assumes font glyphs are ordered (they are in our embedded fonts) */
 		s32 idx = text.data[i] - 32;
-		Rectangle dst = {
-			pos.x + font.glyphs[idx].offsetX - font.glyphPadding,
-			pos.y + font.glyphs[idx].offsetY - font.glyphPadding,
-			font.recs[idx].width  + 2.0f * font.glyphPadding,
-			font.recs[idx].height + 2.0f * font.glyphPadding
+		Rectangle rec   = atlas.recs[idx];
+		GlyphInfo glyph = atlas.glyphs[idx];
+		quads[i].dst = (Rect){
+			.pos  = {.x = *x + (glyph.offsetX - pad) * scale, .y = (glyph.offsetY - pad) * scale},
+			.size = {.w = (rec.width + 2 * pad) * scale,      .h = (rec.height + 2 * pad) * scale},
 		};
-		Rectangle src = {
-			font.recs[idx].x - font.glyphPadding,
-			font.recs[idx].y - font.glyphPadding,
-			font.recs[idx].width  + 2.0f * font.glyphPadding,
-			font.recs[idx].height + 2.0f * font.glyphPadding
+		quads[i].src = (Rect){
+			.pos  = {.x = rec.x - pad,         .y = rec.y - pad},
+			.size = {.w = rec.width + 2 * pad, .h = rec.height + 2 * pad},
 		};
-		DrawTexturePro(font.texture, src, dst, (Vector2){0}, 0, colour);
 
-		pos.x += font.glyphs[idx].advanceX;
-		if (font.glyphs[idx].advanceX == 0)
-			pos.x += font.recs[idx].width;
+		*x += glyph.advanceX * scale;
+		if (glyph.advanceX == 0)
+			*x += rec.width * scale;
+	}
+	return count;
+}
+
+/* NOTE: submits every quad as part of a single rlgl batch on the font atlas */
+function void
+emit_glyph_quads(SDFFont font, GlyphQuad *quads, s64 count, v2 pos, Color colour)
+{
+	f32 tw = font.atlas.texture.width, th = font.atlas.texture.height;
+
+	rlCheckRenderBatchLimit(4 * count);
+	rlSetTexture(font.atlas.texture.id);
+	rlBegin(RL_QUADS);
+	rlColor4ub(colour.r, colour.g, colour.b, colour.a);
+	rlNormal3f(0, 0, 1);
+	for (s64 i = 0; i < count; i++) {
+		Rect d = quads[i].dst, s = quads[i].src;
+		f32 x0 = pos.x + d.pos.x, x1 = x0 + d.size.w;
+		f32 y0 = pos.y + d.pos.y, y1 = y0 + d.size.h;
+		f32 u0 = s.pos.x / tw,    u1 = (s.pos.x + s.size.w) / tw;
+		f32 v0 = s.pos.y / th,    v1 = (s.pos.y + s.size.h) / th;
+		rlTexCoord2f(u0, v0); rlVertex2f(x0, y0);
+		rlTexCoord2f(u0, v1); rlVertex2f(x0, y1);
+		rlTexCoord2f(u1, v1); rlVertex2f(x1, y1);
+		rlTexCoord2f(u1, v0); rlVertex2f(x1, y0);
 	}
+	rlEnd();
+	rlSetTexture(0);
+}
+
+/* NOTE: shadow_colour.a == 0 draws no shadow; otherwise the shadow reuses the same quads */
+function void
+draw_text_with_shadow(SDFFont font, str8 text, v2 pos, Color colour, Color shadow_colour)
+{
+	GlyphQuad quads[64];
+	f32 x = 0;
+	BeginShaderMode(font.shader);
+	while (text.length) {
+		s64 count = layout_glyph_quads(font, text, &x, quads, countof(quads));
+		if (shadow_colour.a)
+			emit_glyph_quads(font, quads, count, add_v2(pos, TEXT_SHADOW_OFFSET), shadow_colour);
+		emit_glyph_quads(font, quads, count, pos, colour);
+		text.data   += count;
+		text.length -= count;
+	}
+	EndShaderMode();
+}
+
+function void
+draw_text(SDFFont font, str8 text, v2 pos, Color colour)
+{
+	draw_text_with_shadow(font, text, pos, colour, (Color){0});
 }
 
 function v2
-left_align_text_in_rect(Rect r, str8 text, Font font)
+left_align_text_in_rect(Rect r, str8 text, SDFFont font)
 {
 	v2 ts    = measure_text(font, text);
 	v2 delta = { .h = r.size.h - ts.h };
@@ -150,8 +299,41 @@ scale_rect_centered(Rect r, v2 scale)
 	return r;
 }
 
+function Rect
+expand_rect(Rect r, v2 by)
+{
+	r.pos.x  -= by.x;
+	r.pos.y  -= by.y;
+	r.size.w += 2 * by.x;
+	r.size.h += 2 * by.y;
+	return r;
+}
+
+/* NOTE: smallest rect containing both; empty rects are ignored */
+function Rect
+union_rect(Rect a, Rect b)
+{
+	Rect result = a;
+	if (a.size.w <= 0 || a.size.h <= 0) {
+		result = b;
+	} else if (b.size.w > 0 && b.size.h > 0) {
+		v2 min = {.x = Min(a.pos.x, b.pos.x), .y = Min(a.pos.y, b.pos.y)};
+		v2 max = {.x = Max(a.pos.x + a.size.w, b.pos.x + b.size.w),
+		          .y = Max(a.pos.y + a.size.h, b.pos.y + b.size.h)};
+		result = (Rect){.pos = min, .size = {.w = max.x - min.x, .h = max.y - min.y}};
+	}
+	return result;
+}
+
+function b32
+animating(f32 t, f32 rest_a, f32 rest_b)
+{
+	b32 result = t != rest_a && t != rest_b;
+	return result;
+}
+
 function v2
-center_align_text_in_rect(Rect r, str8 text, Font font)
+center_align_text_in_rect(Rect r, str8 text, SDFFont font)
 {
 	v2 ts    = measure_text(font, text);
 	v2 delta = { .w = r.size.w - ts.w, .h = r.size.h - ts.h };
@@ -250,30 +432,6 @@ draw_cardinal_triangle(v2 midpoint, v2 size, v2 scale, enum cardinal_direction d
 	#endif
 }
 
-function v4
-convert_colour(v4 colour, ColourKind current, ColourKind target)
-{
-	v4 result = colour;
-	switch (current) {
-	case ColourKind_RGB: {
-		switch (target) {
-		case ColourKind_RGB: break;
-		case ColourKind_HSV: result = rgb_to_hsv(colour); break;
-		InvalidDefaultCase;
-		}
-	} break;
-	case ColourKind_HSV: {
-		switch (target) {
-		case ColourKind_RGB: result = hsv_to_rgb(colour); break;
-		case ColourKind_HSV: break;
-		InvalidDefaultCase;
-		}
-	} break;
-	InvalidDefaultCase;
-	}
-	return result;
-}
-
 function v4
 get_formatted_colour(ColourPickerCtx *ctx, ColourKind format)
 {
@@ -284,11 +442,43 @@ get_formatted_colour(ColourPickerCtx *ctx, ColourKind format)
 function void
 store_formatted_colour(ColourPickerCtx *ctx, v4 colour, ColourKind format)
 {
-	ctx->colour = convert_colour(colour, format, ctx->stored_colour_kind);
+	v4 stored = convert_colour(colour, format, ctx->stored_colour_kind);
 
-	/* TODO(rnp): what exactly was going on here? shouldn't we always redraw the texture ? */
-	if (ctx->stored_colour_kind == ColourKind_HSV)
-		ctx->flags |= ColourPickerFlag_RefillTexture;
+	/* NOTE: the picker stores its colour every frame; only a real change needs a redraw */
+	b32 changed = 0;
+	for (u32 i = 0; i < countof(stored.E); i++)
+		changed |= stored.E[i] != ctx->colour.E[i];
+	if (changed) ctx->flags |= ColourPickerFlag_RefillTexture;
+
+	ctx->colour = stored;
+}
+
+function void
+publish_colour(SharedColour *shared, v4 colour, ColourKind kind)
+{
+	/* NOTE: readers poll this; leave the sequence alone unless something changed */
+	b32 changed = shared->version != SHARED_COLOUR_VERSION || shared->colour_kind != kind;
+	for (u32 i = 0; i < countof(colour.E); i++)
+		changed |= shared->colour.E[i] != colour.E[i];
+
+	if (changed) {
+		v4  rgba     = convert_colour(colour, kind, ColourKind_RGB);
+		u32 rgba8    = pack_rl_colour(rl_colour_from_normalized(rgba));
+		u64 hex      = hex_chars_from_u32(rgba8);
+		u32 sequence = shared->sequence;
+
+		atomic_store_u32(&shared->sequence, sequence + 1);
+		store_fence();
+
+		shared->version     = SHARED_COLOUR_VERSION;
+		shared->colour      = colour;
+		shared->rgba        = rgba;
+		shared->colour_kind = kind;
+		shared->rgba8       = rgba8;
+		memory_copy(shared->hex, &hex, sizeof(shared->hex));
+
+		atomic_store_u32(&shared->sequence, sequence + 2);
+	}
 }
 
 function void
@@ -378,7 +568,8 @@ function void
 do_text_input(ColourPickerCtx *ctx, Rect r, Color colour, s32 max_disp_chars)
 {
 	TextInputState *is = &ctx->text_input_state;
-	v2 ts  = measure_text(ctx->font, (str8){.length = is->count, .data = is->buf});
+	TextLayout *layout = text_layout(ctx->font, (str8){.length = is->count, .data = is->buf});
+	v2 ts  = layout->size;
 	v2 pos = {.x = r.pos.x, .y = r.pos.y + (r.size.y - ts.y) / 2};
 
 	s32 buf_delta = is->count - max_disp_chars;
@@ -386,8 +577,8 @@ do_text_input(ColourPickerCtx *ctx, Rect r, Color colour, s32 max_disp_chars)
 	str8 buf = {.length = is->count - buf_delta, .data = is->buf + buf_delta};
 	{
 		/* NOTE: drop a char if the subtext still doesn't fit */
-		v2 nts = measure_text(ctx->font, buf);
-		if (nts.w > 0.96 * r.size.w) {
+		f32 visible_width = layout->prefix[is->count] - layout->prefix[buf_delta];
+		if (visible_width > 0.96 * r.size.w) {
 			buf.data++;
 			buf.length--;
 		}
@@ -404,25 +595,21 @@ do_text_input(ColourPickerCtx *ctx, Rect r, Color colour, s32 max_disp_chars)
 	bg.a  = 0;
 	Color cursor_colour = rl_colour_from_normalized(lerp_v4(bg, ctx->cursor_colour, is->cursor_t));
 
-	/* NOTE: guess a cursor position */
+	/* NOTE: guess a cursor position: the first glyph which starts at or past the mouse */
 	if (is->cursor == -1) {
 		/* NOTE: extra offset to help with putting a cursor at idx 0 */
 		#define TEXT_HALF_CHAR_WIDTH 10
-		f32 x_off = TEXT_HALF_CHAR_WIDTH, x_bounds = r.size.w * is->cursor_hover_p;
-		s32 i;
-		for (i = 0; i < is->count && x_off < x_bounds; i++) {
-			/* NOTE: assumes font glyphs are ordered */
-			s32 idx = is->buf[i] - 32;
-			x_off  += ctx->font.glyphs[idx].advanceX;
-			if (ctx->font.glyphs[idx].advanceX == 0)
-				x_off += ctx->font.recs[idx].width;
+		f32 x_bounds = r.size.w * is->cursor_hover_p - TEXT_HALF_CHAR_WIDTH;
+		s32 low = 0, high = is->count;
+		while (low < high) {
+			s32 mid = (low + high) / 2;
+			if (layout->prefix[mid] < x_bounds) low  = mid + 1;
+			else                                high = mid;
 		}
-		is->cursor = i;
+		is->cursor = low;
 	}
 
-	buf.length = is->cursor - buf_delta;
-	v2 sts = measure_text(ctx->font, buf);
-	f32 cursor_x = r.pos.x + sts.x;
+	f32 cursor_x = r.pos.x + layout->prefix[is->cursor] - layout->prefix[buf.data - is->buf];
 	f32 cursor_width;
 	if (is->cursor == is->count) cursor_width = Min(ctx->window_size.w * 0.03, 20);
 	else                         cursor_width = Min(ctx->window_size.w * 0.01, 6);
@@ -439,9 +626,9 @@ do_text_input(ColourPickerCtx *ctx, Rect r, Color colour, s32 max_disp_chars)
 	     is->count < (s32)countof(is->buf) && key > 0;
 	     key = GetCharPressed())
 	{
-		mem_move(is->buf + is->cursor + 1,
-		         is->buf + is->cursor,
-		         is->count - is->cursor);
+		memory_move(is->buf + is->cursor + 1,
+		            is->buf + is->cursor,
+		            is->count - is->cursor);
 
 		is->buf[is->cursor++] = key;
 		is->count++;
@@ -453,17 +640,17 @@ do_text_input(ColourPickerCtx *ctx, Rect r, Color colour, s32 max_disp_chars)
 	if ((IsKeyPressed(KEY_BACKSPACE) || IsKeyPressedRepeat(KEY_BACKSPACE)) && is->cursor > 0) {
 		is->cursor--;
 		if (is->cursor < (s32)countof(is->buf) - 1) {
-			mem_move(is->buf + is->cursor,
-			         is->buf + is->cursor + 1,
-			         is->count - is->cursor - 1);
+			memory_move(is->buf + is->cursor,
+			            is->buf + is->cursor + 1,
+			            is->count - is->cursor - 1);
 		}
 		is->count--;
 	}
 
 	if ((IsKeyPressed(KEY_DELETE) || IsKeyPressedRepeat(KEY_DELETE)) && is->cursor < is->count) {
-		mem_move(is->buf + is->cursor,
-		         is->buf + is->cursor + 1,
-		         is->count - is->cursor - 1);
+		memory_move(is->buf + is->cursor,
+		            is->buf + is->cursor + 1,
+		            is->count - is->cursor - 1);
 		is->count--;
 	}
 
@@ -512,11 +699,9 @@ do_text_button(ColourPickerCtx *ctx, ButtonState *btn, v2 mouse, Rect r, str8 te
 	s32 pressed_mask = do_rect_button(btn, mouse, r, bg, HOVER_SPEED, 1, 1);
 
 	v2 tpos   = center_align_text_in_rect(r, text, ctx->font);
-	v2 spos   = {.x = tpos.x + 1.75, .y = tpos.y + 2};
 	v4 colour = lerp_v4(fg, ctx->hover_colour, btn->hover_t);
 
-	draw_text(ctx->font, text, spos, fade(BLACK, 0.8));
-	draw_text(ctx->font, text, tpos, rl_colour_from_normalized(colour));
+	draw_text_with_shadow(ctx->font, text, tpos, rl_colour_from_normalized(colour), TEXT_SHADOW_COLOUR);
 
 	return pressed_mask;
 }
@@ -539,8 +724,11 @@ do_slider(ColourPickerCtx *ctx, Rect r, s32 label_idx, v2 relative_mouse, str8 n
 			current = (relative_mouse.x - sr.pos.x) / sr.size.w;
 		current += wheel / 255;
 		current = Clamp01(current);
-		ctx->colour.E[ctx->held_idx] = current;
-		ctx->flags |= ColourPickerFlag_RefillTexture;
+		/* NOTE: merely hovering sets held_idx; only a real change invalidates the texture */
+		if (current != ctx->colour.E[ctx->held_idx]) {
+			ctx->colour.E[ctx->held_idx] = current;
+			ctx->flags |= ColourPickerFlag_RefillTexture;
+		}
 	}
 
 	if (IsMouseButtonUp(MOUSE_BUTTON_LEFT))
@@ -609,12 +797,15 @@ do_status_bar(ColourPickerCtx *ctx, Rect r, v2 relative_mouse)
 
 	str8 mode_txt = str8("");
 	switch (ctx->stored_colour_kind) {
-	case ColourKind_RGB: mode_txt = str8("RGB"); break;
-	case ColourKind_HSV: mode_txt = str8("HSV"); break;
+	case ColourKind_RGB:   mode_txt = str8("RGB");   break;
+	case ColourKind_HSV:   mode_txt = str8("HSV");   break;
+	case ColourKind_OKLab: mode_txt = str8("OKLab"); break;
+	case ColourKind_OKLCH: mode_txt = str8("OKLCH"); break;
 	InvalidDefaultCase;
 	}
 
 	v2 mode_ts     = measure_text(ctx->font, mode_txt);
+	mode_r.pos.x   = Min(mode_r.pos.x, r.pos.x + r.size.w - mode_ts.w);
 	mode_r.pos.y  += (mode_r.size.h - mode_ts.h) / 2;
 	mode_r.size.w  = mode_ts.w;
 
@@ -770,12 +961,9 @@ do_colour_selector(ColourPickerCtx *ctx, Rect r)
 
 		v4 colour = lerp_v4(fg, ctx->hover_colour, ctx->selection_hover_t[i]);
 
-		v2 fpos = center_align_text_in_rect(cs[i], labels[i], ctx->font);
-		v2 pos  = fpos;
-		pos.x  += 1.75;
-		pos.y  += 2;
-		draw_text(ctx->font, labels[i], pos,  fade(BLACK, 0.8));
-		draw_text(ctx->font, labels[i], fpos, rl_colour_from_normalized(colour));
+		v2 pos = center_align_text_in_rect(cs[i], labels[i], ctx->font);
+		draw_text_with_shadow(ctx->font, labels[i], pos, rl_colour_from_normalized(colour),
+		                      TEXT_SHADOW_COLOUR);
 	}
 
 	DrawRectangleRoundedLinesEx(r.rr, SELECTOR_ROUNDNESS, 0, 4 * SELECTOR_BORDER_WIDTH, ctx->bg);
@@ -792,11 +980,39 @@ do_colour_selector(ColourPickerCtx *ctx, Rect r)
 	if (pressed_idx != -1) {
 		ctx->pms.base_hue       = get_formatted_colour(ctx, ColourKind_HSV).x;
 		ctx->pms.fractional_hue = 0;
+		ctx->flags |= ColourPickerFlag_RefillTexture;
 	}
 }
 
+/* NOTE: an element has to be redrawn when the mouse is or was over it (its hover state
+ * can change) or while one of its animations is in flight */
+function b32
+element_damaged(ColourPickerCtx *ctx, Rect r, v2 relative_mouse, b32 animated)
+{
+	b32 result = animated || point_in_rect(relative_mouse, r) ||
+	             point_in_rect(ctx->last_mode_mouse, r);
+	return result;
+}
+
+/* NOTE: rounded outwards so that partially covered pixels are redrawn too */
+function void
+begin_damage_scissor(Rect damage)
+{
+	f32 end_x = damage.pos.x + damage.size.w;
+	f32 end_y = damage.pos.y + damage.size.h;
+	s32 x0 = (s32)damage.pos.x, y0 = (s32)damage.pos.y;
+	s32 x1 = (s32)end_x,        y1 = (s32)end_y;
+	x0 -= (f32)x0 > damage.pos.x;
+	y0 -= (f32)y0 > damage.pos.y;
+	x1 += (f32)x1 < end_x;
+	y1 += (f32)y1 < end_y;
+	BeginScissorMode(x0, y0, x1 - x0, y1 - y0);
+}
+
+/* NOTE: the shader works in framebuffer coordinates so only the damaged part of r needs
+ * to be covered for it to produce the same pixels there */
 function void
-do_slider_shader(ColourPickerCtx *ctx, Rect r, s32 colour_mode, f32 *regions, f32 *colours)
+do_slider_shader(ColourPickerCtx *ctx, Rect r, Rect damage, s32 colour_mode, f32 *regions, f32 *colours)
 {
 	f32 border_thick = SLIDER_BORDER_WIDTH;
 	f32 radius       = SLIDER_ROUNDNESS / 2;
@@ -811,12 +1027,12 @@ do_slider_shader(ColourPickerCtx *ctx, Rect r, s32 colour_mode, f32 *regions, f3
 	rlSetUniform(ctx->colour_mode_id,  &colour_mode,  RL_SHADER_UNIFORM_INT,   1);
 	rlSetUniform(ctx->colours_id,      colours,       RL_SHADER_UNIFORM_VEC4,  3);
 	rlSetUniform(ctx->regions_id,      regions,       RL_SHADER_UNIFORM_VEC4,  4);
-	DrawRectanglePro(r.rr, (Vector2){0}, 0, BLACK);
+	DrawRectanglePro(damage.rr, (Vector2){0}, 0, BLACK);
 	EndShaderMode();
 }
 
 function void
-do_slider_mode(ColourPickerCtx *ctx, v2 relative_mouse)
+do_slider_mode(ColourPickerCtx *ctx, v2 relative_mouse, b32 full_redraw)
 {
 	BEGIN_CYCLE_COUNT(CC_DO_SLIDER);
 
@@ -832,20 +1048,44 @@ do_slider_mode(ColourPickerCtx *ctx, v2 relative_mouse)
 	ss.size.h *= 0.15;
 	ss.pos.y  += 1.2 * sb.size.h;
 
-	BeginTextureMode(ctx->slider_texture);
-	ClearBackground(ctx->bg);
-
-	do_status_bar(ctx, sb, relative_mouse);
-
 	Rect sr;
 	get_slider_subrects(ss, 0, &sr, 0);
 	f32 r_bound = sr.pos.x + sr.size.w;
 	f32 y_step  = 1.525 * ss.size.h;
 
+	Rect damage = tr;
+	if (!full_redraw) {
+		damage = (Rect){0};
+
+		TextInputState *tis = &ctx->text_input_state;
+		b32 sb_animated = animating(ctx->sbs.hex_hover_t, 0, 1) || tis->idx == INPUT_HEX ||
+		                  animating(ctx->slider_mode_state.colour_kind_cycler.parameter, 0, 1);
+		if (element_damaged(ctx, sb, relative_mouse, sb_animated))
+			damage = union_rect(damage, sb);
+
+		/* NOTE: the markers stick out of the row when scaled up */
+		Rect row = expand_rect(ss, (v2){.y = SLIDER_TRI_SIZE.y * SLIDER_SCALE_TARGET});
+		for (s32 i = 0; i < 4; i++) {
+			b32 animated = animating(ctx->ss.scale_t[i], 1, SLIDER_SCALE_TARGET) ||
+			               animating(ctx->ss.colour_t[i], 0, 1) || tis->idx == i + 1;
+			if (element_damaged(ctx, row, relative_mouse, animated))
+				damage = union_rect(damage, row);
+			row.pos.y += y_step;
+		}
+	}
+
+	BeginTextureMode(ctx->slider_texture);
+	begin_damage_scissor(damage);
+	ClearBackground(ctx->bg);
+
+	do_status_bar(ctx, sb, relative_mouse);
+
 
 	local_persist str8 colour_slider_labels[ColourKind_Last][4] = {
-		[ColourKind_RGB] = { str8("R"), str8("G"), str8("B"), str8("A") },
-		[ColourKind_HSV] = { str8("H"), str8("S"), str8("V"), str8("A") },
+		[ColourKind_RGB]   = { str8("R"), str8("G"), str8("B"), str8("A") },
+		[ColourKind_HSV]   = { str8("H"), str8("S"), str8("V"), str8("A") },
+		[ColourKind_OKLab] = { str8("L"), str8("a"), str8("b"), str8("A") },
+		[ColourKind_OKLCH] = { str8("L"), str8("C"), str8("H"), str8("A") },
 	};
 	for (s32 i = 0; i < 4; i++) {
 		str8 name = colour_slider_labels[ctx->stored_colour_kind][i];
@@ -862,10 +1102,13 @@ do_slider_mode(ColourPickerCtx *ctx, v2 relative_mouse)
 		sr.pos.x, start_y + 0 * y_step, r_bound, end_y + 0 * y_step
 	};
 	v4 colours[3] = {ctx->colour};
-	do_slider_shader(ctx, tr, ctx->stored_colour_kind, regions, (f32 *)colours);
+	do_slider_shader(ctx, tr, damage, ctx->stored_colour_kind, regions, (f32 *)colours);
 
+	EndScissorMode();
 	EndTextureMode();
 
+	ctx->last_mode_mouse = relative_mouse;
+
 	END_CYCLE_COUNT(CC_DO_SLIDER);
 }
 
@@ -914,7 +1157,7 @@ do_vertical_slider(ColourPickerCtx *ctx, v2 test_pos, Rect r, s32 idx,
 }
 
 function void
-do_picker_mode(ColourPickerCtx *ctx, v2 relative_mouse)
+do_picker_mode(ColourPickerCtx *ctx, v2 relative_mouse, b32 full_redraw)
 {
 	BEGIN_CYCLE_COUNT(CC_DO_PICKER);
 
@@ -932,7 +1175,21 @@ do_picker_mode(ColourPickerCtx *ctx, v2 relative_mouse)
 	Rect hs2 = scale_rect_centered(cut_rect_middle(tr, 0.2, 0.4), (v2){.x = 0.5, .y = 0.95});
 	Rect sv  = scale_rect_centered(cut_rect_right(tr, 0.4),       (v2){.x = 1.0, .y = 0.95});
 
+	Rect damage = tr;
+	if (!full_redraw) {
+		damage = (Rect){0};
+		/* NOTE: large enough for the slider markers and the SV cursor at full scale */
+		v2   margin     = {.x = 24, .y = 24};
+		Rect regions[3] = {[PM_LEFT] = hs1, [PM_MIDDLE] = hs2, [PM_RIGHT] = sv};
+		for (u32 i = 0; i < countof(regions); i++) {
+			Rect r = expand_rect(regions[i], margin);
+			if (element_damaged(ctx, r, relative_mouse, animating(ctx->pms.scale_t[i], 0, 1)))
+				damage = union_rect(damage, r);
+		}
+	}
+
 	BeginTextureMode(ctx->picker_texture);
+	begin_damage_scissor(damage);
 	ClearBackground(ctx->bg);
 
 	v4 hsv[3] = {colour, colour, colour};
@@ -964,7 +1221,7 @@ do_picker_mode(ColourPickerCtx *ctx, v2 relative_mouse)
 			hs2.pos.x, hs2.pos.y, hs2.pos.x + hs2.size.w, hs2.pos.y + hs2.size.h,
 			sv.pos.x,  sv.pos.y,  sv.pos.x  + sv.size.w,  sv.pos.y  + sv.size.h
 		};
-		do_slider_shader(ctx, tr, ColourKind_HSV, regions, (f32 *)hsv);
+		do_slider_shader(ctx, tr, damage, ColourKind_HSV, regions, (f32 *)hsv);
 	}
 
 	b32 hovering = CheckCollisionPointRec(relative_mouse.rv, sv.rr);
@@ -1022,8 +1279,11 @@ do_picker_mode(ColourPickerCtx *ctx, v2 relative_mouse)
 		DrawLineEx(start.rv, end.rv, 4, ctx->fg);
 	}
 
+	EndScissorMode();
 	EndTextureMode();
 
+	ctx->last_mode_mouse = relative_mouse;
+
 	if (IsMouseButtonUp(MOUSE_BUTTON_LEFT))
 		ctx->held_idx = -1;
 
@@ -1136,6 +1396,7 @@ colour_picker_end_interact(ColourPickerCtx *ctx, b32 mouse_left_pressed, b32 mou
 		ctx->colour = convert_colour(ctx->colour, ctx->stored_colour_kind,
 		                             is->active->cycler.state);
 		ctx->stored_colour_kind = is->active->cycler.state;
+		ctx->flags |= ColourPickerFlag_RefillTexture;
 	}
 
 	is->kind   = InteractionKind_None;
@@ -1170,9 +1431,45 @@ colour_picker_interact(ColourPickerCtx *ctx, v2 mouse)
 	ctx->last_mouse = mouse;
 }
 
+/* NOTE: true when the active mode's texture may no longer match what it would draw now:
+ * the colour/kind/mode changed (RefillTexture), there was input, or an animation drawn
+ * into it hasn't settled. Otherwise the mode isn't run and its texture is reused. */
+function b32
+mode_texture_dirty(ColourPickerCtx *ctx, b32 mouse_moved)
+{
+	b32 result = (ctx->flags & ColourPickerFlag_RefillTexture) != 0;
+	result |= mouse_moved || GetMouseWheelMove() != 0;
+	result |= IsMouseButtonDown(MOUSE_BUTTON_LEFT) || IsMouseButtonReleased(MOUSE_BUTTON_LEFT);
+	result |= ctx->held_idx != -1;
+	/* NOTE: typing and the blinking cursor */
+	result |= ctx->text_input_state.idx != -1;
+
+	switch (ctx->mode) {
+	case CPM_PICKER:{
+		for (u32 i = 0; i < countof(ctx->pms.scale_t); i++)
+			result |= animating(ctx->pms.scale_t[i], 0, 1);
+	}break;
+	case CPM_SLIDERS:{
+		for (u32 i = 0; i < countof(ctx->ss.scale_t); i++) {
+			result |= animating(ctx->ss.scale_t[i], 1, SLIDER_SCALE_TARGET);
+			result |= animating(ctx->ss.colour_t[i], 0, 1);
+		}
+		result |= animating(ctx->sbs.hex_hover_t, 0, 1);
+		result |= animating(ctx->slider_mode_state.colour_kind_cycler.parameter, 0, 1);
+	}break;
+	case CPM_LAST:{ assert(0); }break;
+	}
+
+	return result;
+}
+
 function void
 colour_picker_init(ColourPickerCtx *ctx)
 {
+	/* NOTE: the shaders are compiled during the first frame; split them out of that phase */
+	if (ctx->startup_profile)
+		startup_profile_mark(ctx->startup_profile, StartupPhase_FirstFrame);
+
 #ifdef _DEBUG
 	ctx->picker_shader   = LoadShader(0, HSV_LERP_SHADER_NAME);
 #else
@@ -1185,9 +1482,20 @@ colour_picker_init(ColourPickerCtx *ctx)
 	ctx->radius_id       = GetShaderLocation(ctx->picker_shader, "u_radius");
 	ctx->border_thick_id = GetShaderLocation(ctx->picker_shader, "u_border_thick");
 
+#ifdef _DEBUG
+	ctx->font.shader     = LoadShader(0, SDF_TEXT_SHADER_NAME);
+#else
+	ctx->font.shader     = LoadShaderFromMemory(0, (char *)sdf_text_bytes);
+#endif
+
+	if (ctx->startup_profile)
+		startup_profile_mark(ctx->startup_profile, StartupPhase_Shader);
+
 	local_persist str8 colour_kind_labels[ColourKind_Last] = {
-		[ColourKind_RGB] = str8("RGB"),
-		[ColourKind_HSV] = str8("HSV"),
+		[ColourKind_RGB]   = str8("RGB"),
+		[ColourKind_HSV]   = str8("HSV"),
+		[ColourKind_OKLab] = str8("OKLab"),
+		[ColourKind_OKLCH] = str8("OKLCH"),
 	};
 	ctx->slider_mode_state.colour_kind_cycler.kind  = VariableKind_Cycler;
 	ctx->slider_mode_state.colour_kind_cycler.flags = VariableFlag_UpdateStoredMode;
@@ -1210,14 +1518,16 @@ do_colour_picker(ColourPickerCtx *ctx, f32 dt, Vector2 window_pos, Vector2 mouse
 		ctx->window_size.w = ctx->window_size.h / WINDOW_ASPECT_RATIO;
 		SetWindowSize(ctx->window_size.w, ctx->window_size.h);
 
-		UnloadTexture(ctx->font.texture);
-		if (ctx->window_size.w < 480) ctx->font = LoadFont_lora_sb_1_inc();
-		else                          ctx->font = LoadFont_lora_sb_0_inc();
+		/* NOTE: the same breakpoint the old half size atlas was swapped in at */
+		ctx->font.scale = ctx->window_size.w < 480 ? 0.5f : 1.0f;
 	}
 
 	if (!(ctx->flags & ColourPickerFlag_Ready))
 		colour_picker_init(ctx);
 
+	b32 mouse_moved = ctx->mouse_pos.x  != mouse_pos.x  || ctx->mouse_pos.y  != mouse_pos.y ||
+	                  ctx->window_pos.x != window_pos.x || ctx->window_pos.y != window_pos.y;
+
 	ctx->mouse_pos.rv  = mouse_pos;
 	ctx->window_pos.rv = window_pos;
 
@@ -1254,10 +1564,11 @@ do_colour_picker(ColourPickerCtx *ctx, f32 dt, Vector2 window_pos, Vector2 mouse
 			s32 h = ma.size.h;
 			UnloadRenderTexture(ctx->picker_texture);
 			ctx->picker_texture = LoadRenderTexture(w, h);
+			ctx->flags |= ColourPickerFlag_RefillTexture;
 			if (ctx->mode != CPM_PICKER) {
 				s32 mode  = ctx->mode;
 				ctx->mode = CPM_PICKER;
-				do_picker_mode(ctx, ma_relative_mouse);
+				do_picker_mode(ctx, ma_relative_mouse, 1);
 				ctx->mode = mode;
 			}
 		}
@@ -1267,10 +1578,11 @@ do_colour_picker(ColourPickerCtx *ctx, f32 dt, Vector2 window_pos, Vector2 mouse
 			s32 h = ma.size.h;
 			UnloadRenderTexture(ctx->slider_texture);
 			ctx->slider_texture = LoadRenderTexture(w, h);
+			ctx->flags |= ColourPickerFlag_RefillTexture;
 			if (ctx->mode != CPM_SLIDERS) {
 				s32 mode  = ctx->mode;
 				ctx->mode = CPM_SLIDERS;
-				do_slider_mode(ctx, ma_relative_mouse);
+				do_slider_mode(ctx, ma_relative_mouse, 1);
 				ctx->mode = mode;
 			}
 		}
@@ -1284,14 +1596,29 @@ do_colour_picker(ColourPickerCtx *ctx, f32 dt, Vector2 window_pos, Vector2 mouse
 			}
 		};
 		NPatchInfo tnp = {tr.rr, 0, 0, 0, 0, NPATCH_NINE_PATCH};
+
+		/* NOTE: changes to the colour (or kind, or size) show up all over the texture,
+		 * as do clicks and scrolls which are about to change it. Hover only damages the
+		 * elements under the mouse. */
+		b32 refill      = mode_texture_dirty(ctx, mouse_moved);
+		b32 full_redraw = (ctx->flags & ColourPickerFlag_RefillTexture) ||
+		                  IsMouseButtonDown(MOUSE_BUTTON_LEFT) ||
+		                  IsMouseButtonReleased(MOUSE_BUTTON_LEFT) || GetMouseWheelMove() != 0;
+
+		/* NOTE: cleared first so that anything the mode itself changes is drawn next frame */
+		ctx->flags &= ~ColourPickerFlag_RefillTexture;
+		/* NOTE: nothing moved so whatever the mode last hovered is still hovered. Needed
+		 * since colour_picker_interact runs before this and reads last frame's next_hot */
+		if (!refill) ctx->interaction.next_hot = ctx->interaction.hot;
+
 		switch (ctx->mode) {
 		case CPM_SLIDERS:
-			do_slider_mode(ctx, ma_relative_mouse);
+			if (refill) do_slider_mode(ctx, ma_relative_mouse, full_redraw);
 			DrawTextureNPatch(ctx->slider_texture.texture, tnp, ma.rr, (Vector2){0},
 			                  0, WHITE);
 			break;
 		case CPM_PICKER:
-			do_picker_mode(ctx, ma_relative_mouse);
+			if (refill) do_picker_mode(ctx, ma_relative_mouse, full_redraw);
 			DrawTextureNPatch(ctx->picker_texture.texture, tnp, ma.rr, (Vector2){0}, 0, WHITE);
 			break;
 		case CPM_LAST:
@@ -1391,6 +1718,7 @@ do_colour_picker(ColourPickerCtx *ctx, f32 dt, Vector2 window_pos, Vector2 mouse
 				if (number.result == NumberConversionResult_Success) {
 					v4 new_colour = normalize_colour(number.U64);
 					ctx->colour = convert_colour(new_colour, ColourKind_RGB, ctx->stored_colour_kind);
+					ctx->flags |= ColourPickerFlag_RefillTexture;
 					if (ctx->mode == CPM_PICKER) {
 						f32 hue = get_formatted_colour(ctx, ColourKind_HSV).x;
 						ctx->pms.base_hue       = hue;
@@ -1403,6 +1731,9 @@ do_colour_picker(ColourPickerCtx *ctx, f32 dt, Vector2 window_pos, Vector2 mouse
 		END_CYCLE_COUNT(CC_LOWER);
 	}
 
+	if (ctx->shared_colour)
+		publish_colour(ctx->shared_colour, ctx->colour, ctx->stored_colour_kind);
+
 	END_CYCLE_COUNT(CC_WHOLE_RUN);
 
 	debug_dump_info(ctx);
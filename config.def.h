@@ -1,6 +1,13 @@
 /* NOTE: This is used by gen_incs for generating font_inc.h and shader_inc.h */
 #define FONT_SIZE            40u
 #define HSV_LERP_SHADER_NAME "slider_lerp.glsl"
+#define SDF_TEXT_SHADER_NAME "sdf_text.glsl"
+
+/* NOTE: 1 embeds the font atlas uncompressed so that loading it is a single texture
+ * upload straight from the binary; 0 DEFLATE compresses it and it is inflated into a
+ * temporary buffer when the font is loaded. The raw GRAY_ALPHA atlas is width*height*2
+ * bytes (512K for the default font) against roughly 36K compressed. */
+#define FONT_ATLAS_RAW       0
 
 /* NOTE: Values below here are just used for initializing the ctx in main.
  * They are not needed if you are are embedding into another application. */
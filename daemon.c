@@ -0,0 +1,492 @@
+/* See LICENSE for copyright details */
+
+/* NOTE: conversion daemon listening on a unix domain socket so that scripts don't pay
+ * for process startup on every conversion. Every message is a DaemonHeader followed by
+ * header.size bytes of payload and is answered with a DaemonReply and its payload.
+ * Requests from one connection are answered in order; everything runs on a single
+ * epoll loop. A payload over DAEMON_MAX_PAYLOAD gets a DaemonStatus_TooLarge reply and
+ * the connection is closed since the stream can't be resynchronized.
+ *
+ * DaemonOp_Convert: the payload is any batch input (text lines or a binary stream) and
+ *                   the reply is that input in the format/kind given in the header; any
+ *                   BatchFormat batch mode writes (text, RGBA8, HSV8, HSV16 or F32). This
+ *                   covers parsing (text -> f32), conversion (f32 -> f32) and formatting
+ *                   (binary -> text).
+ * DaemonOp_Nearest: the payload is u32 palette_count, u32 query_count and then that many
+ *                   packed RGBA8 palette colours and queries. The reply is a u32 palette
+ *                   index for each query, nearest by OKLab distance (alpha is ignored).
+ *                   palette_count * query_count may be at most DAEMON_MAX_NEAREST_PAIRS;
+ *                   larger requests get a DaemonStatus_TooLarge reply but, since their
+ *                   payload was read, the connection stays open. */
+#if OS_LINUX
+#include <errno.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#define DAEMON_MAX_PAYLOAD       MB(4)
+#define DAEMON_MAX_EVENTS        64
+#define DAEMON_INPUT_SIZE        KB(4)
+/* NOTE: bounds how long one request can hold up the event loop (~10ms with AVX2) */
+#define DAEMON_MAX_NEAREST_PAIRS (1ull << 24)
+/* NOTE: OKLab distances are at most a few units; padding entries sit at DAEMON_NEAREST_PAD
+ * lightness so they are always further than DAEMON_NEAREST_FAR, the starting distance */
+#define DAEMON_NEAREST_PAD       1e18f
+#define DAEMON_NEAREST_FAR       1e30f
+
+typedef enum {
+	DaemonOp_Convert,
+	DaemonOp_Nearest,
+} DaemonOp;
+
+typedef enum {
+	DaemonFlag_Hex = 1 << 0,
+} DaemonFlags;
+
+typedef enum {
+	DaemonStatus_Ok,
+	DaemonStatus_InvalidLines,
+	DaemonStatus_BadRequest,
+	DaemonStatus_TooLarge,
+} DaemonStatus;
+
+typedef struct {
+	u32 size;
+	u8  op;
+	u8  format;
+	u8  kind;
+	u8  flags;
+} DaemonHeader;
+static_assert(sizeof(DaemonHeader) == 8, "DaemonHeader must be packed");
+
+typedef struct {
+	u32 size;
+	u32 invalid;
+	u8  status;
+	u8  reserved[3];
+} DaemonReply;
+static_assert(sizeof(DaemonReply) == 12, "DaemonReply must be packed");
+
+typedef struct {
+	s32 fd;
+	b32 waiting_to_write;
+
+	/* NOTE: grown as requests need it, up to a header and DAEMON_MAX_PAYLOAD */
+	u8 *input;
+	s64 input_used;
+	s64 input_cap;
+
+	/* NOTE: reply being sent; data[sent..widx) is still outstanding */
+	Stream reply;
+	u32    sent;
+} DaemonClient;
+
+typedef struct {
+	s32         epoll;
+	BatchChunk *chunk;
+} DaemonCtx;
+
+/* NOTE: the palette is in SoA form padded out to whole vectors with entries too far away
+ * to ever be picked. Each lane keeps the first entry which is strictly nearer, so ties go
+ * to the lowest index as they would in a plain scan. */
+function u32
+daemon_nearest_index(f32 *L, f32 *a, f32 *b, u64 count, f32 qL, f32 qa, f32 qb)
+{
+	alignas(32) f32 lanes[F32_LANES];
+	for (u32 i = 0; i < F32_LANES; i++) lanes[i] = (f32)i;
+
+	f32xN index = load_f32xN(lanes), step = set1_f32xN(F32_LANES);
+	f32xN vL    = set1_f32xN(qL), va = set1_f32xN(qa), vb = set1_f32xN(qb);
+	f32xN best_index    = index;
+	f32xN best_distance = set1_f32xN(DAEMON_NEAREST_FAR);
+	for (u64 i = 0; i < count; i += F32_LANES) {
+		f32xN dL = sub_f32xN(load_f32xN(L + i), vL);
+		f32xN da = sub_f32xN(load_f32xN(a + i), va);
+		f32xN db = sub_f32xN(load_f32xN(b + i), vb);
+		f32xN distance = add_f32xN(add_f32xN(mul_f32xN(dL, dL), mul_f32xN(da, da)), mul_f32xN(db, db));
+		f32xN nearer   = greater_f32xN(best_distance, distance);
+		best_distance  = select_f32xN(nearer, distance, best_distance);
+		best_index     = select_f32xN(nearer, index, best_index);
+		index          = add_f32xN(index, step);
+	}
+
+	alignas(32) f32 distances[F32_LANES], indices[F32_LANES];
+	store_f32xN(distances, best_distance);
+	store_f32xN(indices, best_index);
+	u32 result  = (u32)indices[0];
+	f32 nearest = distances[0];
+	for (u32 i = 1; i < F32_LANES; i++) {
+		u32 candidate = (u32)indices[i];
+		if (distances[i] < nearest || (distances[i] == nearest && candidate < result)) {
+			nearest = distances[i];
+			result  = candidate;
+		}
+	}
+	return result;
+}
+
+function void
+daemon_nearest(Stream *s, str8 payload)
+{
+	u32 palette_count = load_u32_unaligned(payload.data + 0);
+	u32 query_count   = load_u32_unaligned(payload.data + 4);
+	u64 padded_count  = (u64)round_up_to(palette_count, F32_LANES);
+
+	u32 *packed  = (u32 *)(payload.data + 8);
+	v4  *colours = malloc(((u64)palette_count + query_count) * sizeof(*colours));
+	f32 *soa     = malloc(3 * padded_count * sizeof(*soa));
+	if (!colours || !soa) {
+		s->errors = 1;
+	} else {
+		oklab_from_rgba8_buffer(colours, packed, palette_count + query_count);
+
+		/* NOTE: undo the storage scaling so that distances are perceptual */
+		f32 *L = soa, *a = soa + padded_count, *b = soa + 2 * padded_count;
+		for (u64 i = 0; i < padded_count; i++) {
+			v4 c = i < palette_count ? colours[i] : (v4){.x = DAEMON_NEAREST_PAD, .y = 0.5f, .z = 0.5f};
+			L[i] = c.x;
+			a[i] = (c.y - 0.5f) * OKLAB_AB_RANGE;
+			b[i] = (c.z - 0.5f) * OKLAB_AB_RANGE;
+		}
+
+		for (u32 i = 0; i < query_count; i++) {
+			v4  q    = colours[palette_count + i];
+			u32 best = daemon_nearest_index(L, a, b, padded_count, q.x,
+			                                (q.y - 0.5f) * OKLAB_AB_RANGE,
+			                                (q.z - 0.5f) * OKLAB_AB_RANGE);
+			stream_append(s, &best, sizeof(best));
+		}
+	}
+
+	free(colours);
+	free(soa);
+}
+
+/* NOTE: builds the reply to one request; returns 0 if the request can't be answered
+ * (and the connection should be dropped) */
+function b32
+daemon_handle_request(DaemonCtx *ctx, DaemonClient *client, DaemonHeader header, str8 payload)
+{
+	DaemonReply reply = {.status = DaemonStatus_BadRequest};
+
+	/* NOTE: a nearest reply is never larger than its payload; a conversion can expand
+	 * many times over (hex -> f32 text) so the reply grows as it fills instead of
+	 * reserving the worst case for every request */
+	s64 reply_cap = (s64)sizeof(reply) + Max(payload.length, (s64)DAEMON_INPUT_SIZE);
+	client->reply = (Stream){.data = malloc((u64)reply_cap), .cap = (u32)reply_cap, .fd = STREAM_GROWABLE};
+	client->sent  = 0;
+	if (!client->reply.data)
+		return 0;
+
+	Stream *s = &client->reply;
+	stream_append(s, &reply, sizeof(reply));
+
+	switch (header.op) {
+	case DaemonOp_Convert:{
+		BatchOutput output = {
+			.format = header.format,
+			.kind   = header.kind,
+			.hex    = (header.flags & DaemonFlag_Hex) != 0,
+		};
+		b32 known_format = header.format == BatchFormat_Text || header.format == BatchFormat_F32 ||
+		                   batch_packed_size((BatchFormat)header.format);
+		if (known_format && header.kind < ColourKind_Last) {
+			s64 invalid = batch_convert_buffer(output, payload, ctx->chunk, s);
+			if (invalid >= 0) {
+				reply.status  = invalid ? DaemonStatus_InvalidLines : DaemonStatus_Ok;
+				reply.invalid = (u32)invalid;
+			}
+		}
+	}break;
+	case DaemonOp_Nearest:{
+		if (payload.length >= 8) {
+			u64 palette_count = load_u32_unaligned(payload.data + 0);
+			u64 query_count   = load_u32_unaligned(payload.data + 4);
+			if (palette_count > 0 && (palette_count + query_count) * 4 + 8 == (u64)payload.length) {
+				if (palette_count * query_count > DAEMON_MAX_NEAREST_PAIRS) {
+					reply.status = DaemonStatus_TooLarge;
+				} else {
+					daemon_nearest(s, payload);
+					reply.status = DaemonStatus_Ok;
+				}
+			}
+		}
+	}break;
+	}
+
+	if (reply.status == DaemonStatus_BadRequest || s->errors) {
+		reply.status = DaemonStatus_BadRequest;
+		s->widx      = sizeof(reply);
+		s->errors    = 0;
+	}
+	reply.size = s->widx - (u32)sizeof(reply);
+	memory_copy(s->data, &reply, sizeof(reply));
+
+	return 1;
+}
+
+function void
+daemon_close_client(DaemonCtx *ctx, DaemonClient *client)
+{
+	epoll_ctl(ctx->epoll, EPOLL_CTL_DEL, client->fd, 0);
+	close(client->fd);
+	free(client->input);
+	free(client->reply.data);
+	free(client);
+}
+
+/* NOTE: returns 0 once the socket would block or the reply is done; -1 on error */
+function s32
+daemon_send(DaemonClient *client)
+{
+	s32 result = 0;
+	while (client->reply.data && client->sent < client->reply.widx) {
+		s64 wrote = send(client->fd, client->reply.data + client->sent,
+		                 client->reply.widx - client->sent, MSG_NOSIGNAL);
+		if (wrote > 0) {
+			client->sent += (u32)wrote;
+		} else {
+			if (wrote < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+				result = -1;
+			if (wrote < 0 && errno == EINTR)
+				continue;
+			break;
+		}
+	}
+
+	if (result == 0 && client->reply.data && client->sent == client->reply.widx) {
+		free(client->reply.data);
+		client->reply = (Stream){0};
+	}
+	return result;
+}
+
+/* NOTE: answers every complete request which is buffered, stopping early if a reply
+ * can't be sent in full yet. Returns 0 if the client should be dropped. */
+function b32
+daemon_process(DaemonCtx *ctx, DaemonClient *client)
+{
+	b32 result   = 1;
+	s64 consumed = 0;
+	while (result && !client->reply.data && client->input_used - consumed >= (s64)sizeof(DaemonHeader)) {
+		DaemonHeader header;
+		memory_copy(&header, client->input + consumed, sizeof(header));
+		if (header.size > DAEMON_MAX_PAYLOAD) {
+			DaemonReply reply = {.status = DaemonStatus_TooLarge};
+			send(client->fd, &reply, sizeof(reply), MSG_NOSIGNAL);
+			result = 0;
+			break;
+		}
+		if (client->input_used - consumed < (s64)sizeof(header) + header.size)
+			break;
+
+		str8 payload = {.length = header.size, .data = client->input + consumed + sizeof(header)};
+		result    = daemon_handle_request(ctx, client, header, payload);
+		consumed += (s64)sizeof(header) + header.size;
+
+		if (result) result = daemon_send(client) == 0;
+	}
+	memory_move(client->input, client->input + consumed, client->input_used - consumed);
+	client->input_used -= consumed;
+
+	/* NOTE: give back the room a large request needed once it has been answered */
+	if (client->input_used == 0 && client->input_cap > (s64)DAEMON_INPUT_SIZE) {
+		u8 *input = realloc(client->input, DAEMON_INPUT_SIZE);
+		if (input) {
+			client->input     = input;
+			client->input_cap = DAEMON_INPUT_SIZE;
+		}
+	}
+
+	/* NOTE: while a reply is stuck only wait for writability. Reading on would just fill
+	 * the input buffer, after which level triggered EPOLLIN fires on every wait. */
+	b32 waiting = client->reply.data != 0;
+	if (result && waiting != client->waiting_to_write) {
+		struct epoll_event event = {.events = waiting ? EPOLLOUT : EPOLLIN, .data.ptr = client};
+		epoll_ctl(ctx->epoll, EPOLL_CTL_MOD, client->fd, &event);
+		client->waiting_to_write = waiting;
+	}
+	return result;
+}
+
+function b32
+daemon_receive(DaemonClient *client)
+{
+	b32 result   = 1;
+	s64 capacity = (s64)(sizeof(DaemonHeader) + DAEMON_MAX_PAYLOAD);
+	for (;;) {
+		if (client->input_used == client->input_cap) {
+			if (client->input_cap == capacity)
+				break;
+			s64 cap   = Min(2 * client->input_cap, capacity);
+			u8 *input = realloc(client->input, (u64)cap);
+			if (!input) {
+				result = 0;
+				break;
+			}
+			client->input     = input;
+			client->input_cap = cap;
+		}
+		s64 read = recv(client->fd, client->input + client->input_used,
+		                (u64)(client->input_cap - client->input_used), 0);
+		if (read > 0) {
+			client->input_used += read;
+		} else {
+			if (read == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+				result = 0;
+			if (read < 0 && errno == EINTR)
+				continue;
+			break;
+		}
+	}
+	return result;
+}
+
+/* NOTE: only removes the socket at path if it is still the one this process bound; it
+ * may have been replaced since */
+function void
+daemon_unlink_socket(char *path, struct stat *bound)
+{
+	struct stat sb;
+	if (lstat(path, &sb) == 0 && sb.st_dev == bound->st_dev && sb.st_ino == bound->st_ino)
+		unlink(path);
+}
+
+function s32
+run_daemon(char *path)
+{
+	struct sockaddr_un address = {.sun_family = AF_UNIX};
+	str8 path_str = str8_from_c_str(path);
+	if (path_str.length >= (s64)sizeof(address.sun_path)) {
+		fprintf(stderr, "daemon: socket path too long: %s\n", path);
+		return 1;
+	}
+	memory_copy(address.sun_path, path_str.data, path_str.length);
+
+	DaemonCtx ctx = {.chunk = malloc(sizeof(*ctx.chunk))};
+	s32 listener  = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	ctx.epoll     = epoll_create1(EPOLL_CLOEXEC);
+
+	/* NOTE: a socket left behind by a previous instance would make bind fail. It is only
+	 * stale if nothing accepts connections on it; anything else at path belongs to
+	 * someone else and is never removed. */
+	struct stat sb;
+	if (lstat(path, &sb) == 0) {
+		if (!S_ISSOCK(sb.st_mode)) {
+			fprintf(stderr, "daemon: %s exists and is not a socket\n", path);
+			return 1;
+		}
+		s32 probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		s32 error = probe < 0 ? errno : 0;
+		if (probe >= 0 && connect(probe, (struct sockaddr *)&address, sizeof(address)) < 0)
+			error = errno;
+		if (probe >= 0) close(probe);
+		if (error != ECONNREFUSED) {
+			if (error) fprintf(stderr, "daemon: failed to check %s\n", path);
+			else       fprintf(stderr, "daemon: %s is in use by another daemon\n", path);
+			return 1;
+		}
+		unlink(path);
+	}
+
+	struct stat bound;
+	b32 listening = ctx.chunk && listener >= 0 && ctx.epoll >= 0 &&
+	                bind(listener, (struct sockaddr *)&address, sizeof(address)) == 0 &&
+	                lstat(path, &bound) == 0;
+	if (listening && listen(listener, 64) < 0) {
+		daemon_unlink_socket(path, &bound);
+		listening = 0;
+	}
+	if (!listening) {
+		fprintf(stderr, "daemon: failed to listen on %s\n", path);
+		return 1;
+	}
+
+	/* NOTE: SIGINT/SIGTERM are read from the epoll loop so that shutting down goes
+	 * through the cleanup below and removes the socket */
+	sigset_t stop_signals;
+	sigemptyset(&stop_signals);
+	sigaddset(&stop_signals, SIGINT);
+	sigaddset(&stop_signals, SIGTERM);
+	s32 signals = -1;
+	if (sigprocmask(SIG_BLOCK, &stop_signals, 0) == 0)
+		signals = signalfd(-1, &stop_signals, SFD_NONBLOCK | SFD_CLOEXEC);
+	if (signals < 0) {
+		fprintf(stderr, "daemon: failed to set up signal handling\n");
+		close(listener);
+		daemon_unlink_socket(path, &bound);
+		return 1;
+	}
+
+	struct epoll_event event = {.events = EPOLLIN, .data.ptr = 0};
+	epoll_ctl(ctx.epoll, EPOLL_CTL_ADD, listener, &event);
+	event.data.ptr = &signals;
+	epoll_ctl(ctx.epoll, EPOLL_CTL_ADD, signals, &event);
+
+	s32 result = 1;
+	struct epoll_event events[DAEMON_MAX_EVENTS];
+	for (b32 running = 1; running;) {
+		s32 count = epoll_wait(ctx.epoll, events, DAEMON_MAX_EVENTS, -1);
+		if (count < 0 && errno != EINTR) {
+			fprintf(stderr, "daemon: epoll_wait failed\n");
+			break;
+		}
+
+		for (s32 i = 0; running && i < count; i++) {
+			DaemonClient *client = events[i].data.ptr;
+			if (events[i].data.ptr == &signals) {
+				running = 0;
+				result  = 0;
+				continue;
+			}
+			if (!client) {
+				s32 fd;
+				while ((fd = accept4(listener, 0, 0, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+					client = calloc(1, sizeof(*client));
+					if (client) client->input = malloc(DAEMON_INPUT_SIZE);
+					if (!client || !client->input) {
+						if (client) free(client);
+						close(fd);
+						continue;
+					}
+					client->fd        = fd;
+					client->input_cap = DAEMON_INPUT_SIZE;
+					struct epoll_event client_event = {.events = EPOLLIN, .data.ptr = client};
+					epoll_ctl(ctx.epoll, EPOLL_CTL_ADD, fd, &client_event);
+				}
+				continue;
+			}
+
+			b32 alive = 1;
+			if (events[i].events & EPOLLOUT)
+				alive = daemon_send(client) == 0;
+			if (alive && (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)))
+				alive = daemon_receive(client);
+			/* NOTE: requests already received are answered even if the peer closed. A
+			 * drained reply also has to come through here to re-arm EPOLLIN. */
+			if (client->input_used || client->waiting_to_write || !alive)
+				alive = daemon_process(&ctx, client) && alive;
+			if (!alive) daemon_close_client(&ctx, client);
+		}
+	}
+
+	close(signals);
+	close(listener);
+	close(ctx.epoll);
+	daemon_unlink_socket(path, &bound);
+	return result;
+}
+
+#else /* !OS_LINUX */
+
+function s32
+run_daemon(char *path)
+{
+	fprintf(stderr, "daemon: not supported on this platform\n");
+	return 1;
+}
+
+#endif /* !OS_LINUX */
@@ -7,6 +7,15 @@
 
 #include "config.h"
 
+/* NOTE: config.h files made before this option existed keep the compressed atlas */
+#ifndef FONT_ATLAS_RAW
+#define FONT_ATLAS_RAW 0
+#endif
+#ifndef SDF_TEXT_SHADER_NAME
+#define SDF_TEXT_SHADER_NAME "sdf_text.glsl"
+#endif
+
+#include <math.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -15,6 +24,22 @@
 
 #define ISSPACE(a)  ((a) == ' ' || (a) == '\t')
 
+#define SRGB_TO_LINEAR_LUT_SIZE 256
+#define LINEAR_TO_SRGB_LUT_SIZE 4096
+
+#define POW10_U128_MIN_EXPONENT (-348)
+#define POW10_U128_MAX_EXPONENT ( 347)
+
+#define ICON_SIZE              128
+#define ICON_GRADIENT_RADIUS   48.0
+#define ICON_RING_INNER_RADIUS 45.0
+#define ICON_SUBSAMPLES        4
+
+#define RYU_F32_POW5_INV_BITCOUNT 59
+#define RYU_F32_POW5_BITCOUNT     61
+#define RYU_F32_POW5_INV_COUNT    31
+#define RYU_F32_POW5_COUNT        48
+
 function str8
 read_whole_file(char *name, str8 *mem)
 {
@@ -44,7 +69,8 @@ read_whole_file(char *name, str8 *mem)
 	return result;
 }
 
-/* NOTE: modified from raylib */
+/* NOTE: modified from raylib. The glyphs are baked as signed distance fields so that the
+ * single atlas can be drawn at any size through the sdf_text shader */
 function void
 export_font_as_code(char *font_path, char *output_name, int font_size, str8 mem)
 {
@@ -54,7 +80,7 @@ export_font_as_code(char *font_path, char *output_name, int font_size, str8 mem)
 	font.glyphCount   = 95;
 	font.glyphPadding = 4;
 
-	font.glyphs = LoadFontData(raw.data, raw.length, font.baseSize, 0, font.glyphCount, FONT_DEFAULT);
+	font.glyphs = LoadFontData(raw.data, raw.length, font.baseSize, 0, font.glyphCount, FONT_SDF);
 	if (font.glyphs == NULL) {
 		printf("Failed to load font data: %s\n", font_path);
 		exit(1);
@@ -74,18 +100,34 @@ export_font_as_code(char *font_path, char *output_name, int font_size, str8 mem)
 
 	#define TEXT_BYTES_PER_LINE 16
 
-	int image_data_size      = GetPixelDataSize(atlas.width, atlas.height, atlas.format);
-	int comp_data_size       = 0;
-	unsigned char *comp_data = CompressData(atlas.data, image_data_size, &comp_data_size);
+	int image_data_size    = GetPixelDataSize(atlas.width, atlas.height, atlas.format);
+	int embedded_data_size = image_data_size;
+	if (FONT_ATLAS_RAW) {
+		// Save font image data (uncompressed, ready to upload)
+		fprintf(fp, "#define DATA_SIZE_FONT_%s %i\n\n", TextToUpper(suffix), image_data_size);
+		fprintf(fp, "// Font image pixels data (GRAY_ALPHA, SDF)\n");
+		fprintf(fp, "alignas(64) static unsigned char fontData_%s[DATA_SIZE_FONT_%s] = { ", suffix, TextToUpper(suffix));
+		unsigned char *data = atlas.data;
+		for (int i = 0; i < image_data_size - 1; i++) fprintf(fp, ((i%TEXT_BYTES_PER_LINE == 0)? "0x%02x,\n    " : "0x%02x, "), data[i]);
+		fprintf(fp, "0x%02x };\n\n", data[image_data_size - 1]);
+	} else {
+		int comp_data_size       = 0;
+		unsigned char *comp_data = CompressData(atlas.data, image_data_size, &comp_data_size);
 
-	// Save font image data (compressed)
-	fprintf(fp, "#define COMPRESSED_DATA_SIZE_FONT_%s %i\n\n", TextToUpper(suffix), comp_data_size);
-	fprintf(fp, "// Font image pixels data compressed (DEFLATE)\n");
-	fprintf(fp, "// NOTE: Original pixel data simplified to GRAYSCALE\n");
-	fprintf(fp, "static unsigned char fontData_%s[COMPRESSED_DATA_SIZE_FONT_%s] = { ", suffix, TextToUpper(suffix));
-	for (int i = 0; i < comp_data_size - 1; i++) fprintf(fp, ((i%TEXT_BYTES_PER_LINE == 0)? "0x%02x,\n    " : "0x%02x, "), comp_data[i]);
-	fprintf(fp, "0x%02x };\n\n", comp_data[comp_data_size - 1]);
-	RL_FREE(comp_data);
+		// Save font image data (compressed)
+		fprintf(fp, "#define COMPRESSED_DATA_SIZE_FONT_%s %i\n\n", TextToUpper(suffix), comp_data_size);
+		fprintf(fp, "// Font image pixels data compressed (DEFLATE, SDF)\n");
+		fprintf(fp, "// NOTE: Original pixel data simplified to GRAYSCALE\n");
+		fprintf(fp, "static unsigned char fontData_%s[COMPRESSED_DATA_SIZE_FONT_%s] = { ", suffix, TextToUpper(suffix));
+		for (int i = 0; i < comp_data_size - 1; i++) fprintf(fp, ((i%TEXT_BYTES_PER_LINE == 0)? "0x%02x,\n    " : "0x%02x, "), comp_data[i]);
+		fprintf(fp, "0x%02x };\n\n", comp_data[comp_data_size - 1]);
+		RL_FREE(comp_data);
+		embedded_data_size = comp_data_size;
+	}
+	/* NOTE: the atlas is the bulk of the embedded font data; report it so that the cost
+	 * of FONT_ATLAS_RAW is visible whenever the includes are regenerated */
+	printf("%s: %dx%d atlas, %d bytes embedded (%s)\n", output_name, atlas.width, atlas.height,
+	       embedded_data_size, FONT_ATLAS_RAW ? "raw" : "DEFLATE");
 
 	// Save font recs data
 	fprintf(fp, "// Font characters rectangles data\n");
@@ -110,14 +152,22 @@ export_font_as_code(char *font_path, char *output_name, int font_size, str8 mem)
 	fprintf(fp, "    font.baseSize = %i;\n", font.baseSize);
 	fprintf(fp, "    font.glyphCount = %i;\n", font.glyphCount);
 	fprintf(fp, "    font.glyphPadding = %i;\n\n", font.glyphPadding);
-	fprintf(fp, "    // Custom font loading\n");
-	fprintf(fp, "    // NOTE: Compressed font image data (DEFLATE), it requires DecompressData() function\n");
-	fprintf(fp, "    int fontDataSize_%s = 0;\n", suffix);
-	fprintf(fp, "    unsigned char *data = DecompressData(fontData_%s, COMPRESSED_DATA_SIZE_FONT_%s, &fontDataSize_%s);\n", suffix, TextToUpper(suffix), suffix);
-	fprintf(fp, "    Image imFont = { data, %i, %i, 1, %i };\n\n", atlas.width, atlas.height, atlas.format);
-	fprintf(fp, "    // Load texture from image\n");
-	fprintf(fp, "    font.texture = LoadTextureFromImage(imFont);\n");
-	fprintf(fp, "    UnloadImage(imFont);  // Uncompressed data can be unloaded from memory\n\n");
+	if (FONT_ATLAS_RAW) {
+		fprintf(fp, "    // NOTE: Font image data is used in place, no copy is made\n");
+		fprintf(fp, "    Image imFont = { fontData_%s, %i, %i, 1, %i };\n", suffix, atlas.width, atlas.height, atlas.format);
+		fprintf(fp, "    font.texture = LoadTextureFromImage(imFont);\n");
+	} else {
+		fprintf(fp, "    // Custom font loading\n");
+		fprintf(fp, "    // NOTE: Compressed font image data (DEFLATE), it requires DecompressData() function\n");
+		fprintf(fp, "    int fontDataSize_%s = 0;\n", suffix);
+		fprintf(fp, "    unsigned char *data = DecompressData(fontData_%s, COMPRESSED_DATA_SIZE_FONT_%s, &fontDataSize_%s);\n", suffix, TextToUpper(suffix), suffix);
+		fprintf(fp, "    Image imFont = { data, %i, %i, 1, %i };\n\n", atlas.width, atlas.height, atlas.format);
+		fprintf(fp, "    // Load texture from image\n");
+		fprintf(fp, "    font.texture = LoadTextureFromImage(imFont);\n");
+		fprintf(fp, "    UnloadImage(imFont);  // Uncompressed data can be unloaded from memory\n");
+	}
+	fprintf(fp, "    // NOTE: SDF glyphs are sampled between texels when scaled\n");
+	fprintf(fp, "    SetTextureFilter(font.texture, TEXTURE_FILTER_BILINEAR);\n\n");
 	fprintf(fp, "    // Assign glyph recs and info data directly\n");
 	fprintf(fp, "    // WARNING: This font data must not be unloaded\n");
 	fprintf(fp, "    font.recs = fontRecs_%s;\n", suffix);
@@ -131,9 +181,10 @@ export_font_as_code(char *font_path, char *output_name, int font_size, str8 mem)
 function void
 generate_shader_include(str8 memory)
 {
-	str8 raw = read_whole_file(HSV_LERP_SHADER_NAME, &memory);
-	// NOTE(rnp): raylib is dumb and wants this to be 0 terminated
-	raw.data[raw.length++] = 0;
+	char *shaders[][2] = {
+		{HSV_LERP_SHADER_NAME, "slider_lerp_bytes"},
+		{SDF_TEXT_SHADER_NAME, "sdf_text_bytes"},
+	};
 
 	char *output_name = "out/shader_inc.h";
 	FILE *fp = fopen(output_name, "w");
@@ -142,18 +193,300 @@ generate_shader_include(str8 memory)
 		exit(1);
 	}
 
+	fprintf(fp, "/* See LICENSE for copyright details */\n\n");
+	fprintf(fp, "// GENERATED CODE\n");
+	for (u32 shader = 0; shader < countof(shaders); shader++) {
+		str8 raw = read_whole_file(shaders[shader][0], &memory);
+		// NOTE(rnp): raylib is dumb and wants this to be 0 terminated
+		raw.data[raw.length++] = 0;
+
+		fprintf(fp, "\nread_only global u8 %s[] = {\n", shaders[shader][1]);
+		for (s64 i = 0; i < raw.length; i++) {
+			b32 end_line = (i != 0) && (i % 16) == 0;
+			if (i != 0) fprintf(fp, end_line ? "," : ", ");
+			if (end_line) fprintf(fp, "\n");
+			if ((i % 16) == 0) fprintf(fp, "\t");
+			fprintf(fp, "0x%02X", raw.data[i]);
+		}
+		fprintf(fp, ", 0x00\n");
+		fprintf(fp, "\n};\n");
+	}
+	fclose(fp);
+}
+
+function f64
+srgb_to_linear(f64 c)
+{
+	f64 result = c <= 0.04045 ? c / 12.92 : pow((c + 0.055) / 1.055, 2.4);
+	return result;
+}
+
+function f64
+linear_to_srgb(f64 c)
+{
+	f64 result = c <= 0.0031308 ? c * 12.92 : 1.055 * pow(c, 1 / 2.4) - 0.055;
+	return result;
+}
+
+/* NOTE: 256 entry table maps every 8 bit sRGB code to linear light. The 4096 entry table
+ * maps linear light quantized to 12 bits back to 8 bit sRGB; 12 bits is enough to round
+ * trip every 8 bit code exactly. */
+function void
+generate_srgb_lut_include(void)
+{
+	char *output_name = "out/srgb_lut_inc.h";
+	FILE *fp = fopen(output_name, "w");
+	if (fp == NULL) {
+		printf("Failed to open output lut file: %s\n", output_name);
+		exit(1);
+	}
+
 	fprintf(fp, "/* See LICENSE for copyright details */\n\n");
 	fprintf(fp, "// GENERATED CODE\n\n");
-	fprintf(fp, "read_only global u8 slider_lerp_bytes[] = {\n");
-	for (s64 i = 0; i < raw.length; i++) {
-		b32 end_line = (i != 0) && (i % 16) == 0;
-		if (i != 0) fprintf(fp, end_line ? "," : ", ");
-		if (end_line) fprintf(fp, "\n");
+	fprintf(fp, "#define SRGB_TO_LINEAR_LUT_SIZE %d\n", SRGB_TO_LINEAR_LUT_SIZE);
+	fprintf(fp, "#define LINEAR_TO_SRGB_LUT_SIZE %d\n\n", LINEAR_TO_SRGB_LUT_SIZE);
+
+	fprintf(fp, "read_only global f32 srgb_to_linear_lut[SRGB_TO_LINEAR_LUT_SIZE] = {\n");
+	for (s32 i = 0; i < SRGB_TO_LINEAR_LUT_SIZE; i++) {
+		f64 linear = srgb_to_linear(i / (f64)(SRGB_TO_LINEAR_LUT_SIZE - 1));
+		if ((i % 4) == 0) fprintf(fp, "\t");
+		fprintf(fp, "%.9ef,", (f32)linear);
+		fprintf(fp, ((i % 4) == 3) ? "\n" : " ");
+	}
+	fprintf(fp, "};\n\n");
+
+	fprintf(fp, "read_only global u8 linear_to_srgb_lut[LINEAR_TO_SRGB_LUT_SIZE] = {\n");
+	for (s32 i = 0; i < LINEAR_TO_SRGB_LUT_SIZE; i++) {
+		f64 srgb = linear_to_srgb(i / (f64)(LINEAR_TO_SRGB_LUT_SIZE - 1));
 		if ((i % 16) == 0) fprintf(fp, "\t");
-		fprintf(fp, "0x%02X", raw.data[i]);
+		fprintf(fp, "0x%02X,", (u32)(srgb * 255 + 0.5));
+		fprintf(fp, ((i % 16) == 15) ? "\n" : " ");
+	}
+	fprintf(fp, "};\n");
+	fclose(fp);
+}
+
+/* NOTE: the window icon is a radial gradient from the picked colour to the background
+ * with a border ring on top. The colours are only known at runtime so only the shape is
+ * baked: the weight of the picked colour and the ring coverage for each pixel. */
+function void
+generate_icon_include(void)
+{
+	char *output_name = "out/icon_inc.h";
+	FILE *fp = fopen(output_name, "w");
+	if (fp == NULL) {
+		printf("Failed to open output icon file: %s\n", output_name);
+		exit(1);
+	}
+
+	fprintf(fp, "/* See LICENSE for copyright details */\n\n");
+	fprintf(fp, "// GENERATED CODE\n\n");
+	fprintf(fp, "#define ICON_SIZE %d\n\n", ICON_SIZE);
+
+	for (s32 mask = 0; mask < 2; mask++) {
+		fprintf(fp, "read_only global u8 %s[ICON_SIZE * ICON_SIZE] = {\n",
+		        mask ? "icon_ring_coverage" : "icon_gradient_weight");
+		for (s32 i = 0; i < ICON_SIZE * ICON_SIZE; i++) {
+			f64 sum = 0;
+			for (s32 sy = 0; sy < ICON_SUBSAMPLES; sy++) {
+				for (s32 sx = 0; sx < ICON_SUBSAMPLES; sx++) {
+					f64 x = (i % ICON_SIZE) + (sx + 0.5) / ICON_SUBSAMPLES - ICON_SIZE / 2;
+					f64 y = (i / ICON_SIZE) + (sy + 0.5) / ICON_SUBSAMPLES - ICON_SIZE / 2;
+					f64 d = sqrt(x * x + y * y);
+					if (mask) sum += d >= ICON_RING_INNER_RADIUS && d <= ICON_GRADIENT_RADIUS;
+					else      sum += d <= ICON_GRADIENT_RADIUS ? 1 - d / ICON_GRADIENT_RADIUS : 0;
+				}
+			}
+			u32 value = (u32)(255 * sum / (ICON_SUBSAMPLES * ICON_SUBSAMPLES) + 0.5);
+			if ((i % 16) == 0) fprintf(fp, "\t");
+			fprintf(fp, "0x%02X,", value);
+			fprintf(fp, ((i % 16) == 15) ? "\n" : " ");
+		}
+		fprintf(fp, "};\n%s", mask ? "" : "\n");
 	}
-	fprintf(fp, ", 0x00\n");
-	fprintf(fp, "\n};\n");
+	fclose(fp);
+}
+
+/* NOTE: just enough of a bignum to compute powers of 5 exactly (5^348 < 2^809) */
+typedef struct {
+	u32 limbs[32];
+	s32 count;
+} BigNum;
+
+function void
+bignum_mul_small(BigNum *b, u32 m)
+{
+	u64 carry = 0;
+	for (s32 i = 0; i < b->count; i++) {
+		u64 t       = (u64)b->limbs[i] * m + carry;
+		b->limbs[i] = (u32)t;
+		carry       = t >> 32;
+	}
+	if (carry) b->limbs[b->count++] = (u32)carry;
+}
+
+function s32
+bignum_bit_length(BigNum *b)
+{
+	s32 result = 0;
+	if (b->count) result = 32 * b->count - (s32)clz_u32(b->limbs[b->count - 1]);
+	return result;
+}
+
+function u32
+bignum_bit(BigNum *b, s32 bit)
+{
+	u32 result = 0;
+	if (bit >= 0 && bit < 32 * b->count) result = (b->limbs[bit / 32] >> (bit % 32)) & 1;
+	return result;
+}
+
+function s32
+bignum_compare(BigNum *a, BigNum *b)
+{
+	s32 result = a->count - b->count;
+	for (s32 i = a->count - 1; result == 0 && i >= 0; i--)
+		if (a->limbs[i] != b->limbs[i]) result = a->limbs[i] < b->limbs[i] ? -1 : 1;
+	return result;
+}
+
+function void
+bignum_sub(BigNum *a, BigNum *b)
+{
+	s64 borrow = 0;
+	for (s32 i = 0; i < a->count; i++) {
+		s64 t = (s64)a->limbs[i] - (i < b->count ? b->limbs[i] : 0) - borrow;
+		borrow      = t < 0;
+		a->limbs[i] = (u32)(t + (borrow << 32));
+	}
+	while (a->count > 0 && a->limbs[a->count - 1] == 0) a->count--;
+}
+
+function void
+bignum_shl1(BigNum *b)
+{
+	u32 carry = 0;
+	for (s32 i = 0; i < b->count; i++) {
+		u32 next    = b->limbs[i] >> 31;
+		b->limbs[i] = b->limbs[i] << 1 | carry;
+		carry       = next;
+	}
+	if (carry) b->limbs[b->count++] = carry;
+}
+
+/* NOTE: 10^e = 5^e * 2^e so only the 128 most significant bits of 5^e (or of 1 / 5^-e)
+ * are stored, normalized so the top bit is set and rounded down. This is the table
+ * used by the Eisel-Lemire algorithm in number_from_str8. */
+function u128
+pow10_u128(s32 e)
+{
+	BigNum five = {.limbs = {1}, .count = 1};
+	for (s32 i = 0; i < (e < 0 ? -e : e); i++) bignum_mul_small(&five, 5);
+
+	u128 result = {0};
+	if (e >= 0) {
+		s32 top = bignum_bit_length(&five) - 1;
+		for (s32 i = 0; i < 128; i++) {
+			u64 bit = bignum_bit(&five, top - i);
+			if (i < 64) result.hi |= bit << (63 - i);
+			else        result.lo |= bit << (127 - i);
+		}
+	} else {
+		/* NOTE: binary long division of 1 by 5^-e, skipping the leading zeros */
+		BigNum remainder = {.limbs = {1}, .count = 1};
+		for (s32 i = 0; i < 128;) {
+			bignum_shl1(&remainder);
+			u64 bit = bignum_compare(&remainder, &five) >= 0;
+			if (bit) bignum_sub(&remainder, &five);
+			if (bit || i > 0) {
+				if (i < 64) result.hi |= bit << (63 - i);
+				else        result.lo |= bit << (127 - i);
+				i++;
+			}
+		}
+	}
+	return result;
+}
+
+/* NOTE: floor(2^n / d) for quotients which fit in 64 bits */
+function u64
+bignum_pow2_div(s32 n, BigNum *d)
+{
+	BigNum remainder = {0};
+	u64    result    = 0;
+	for (s32 bit = n; bit >= 0; bit--) {
+		bignum_shl1(&remainder);
+		if (bit == n) {
+			if (remainder.count == 0) remainder.count = 1;
+			remainder.limbs[0] |= 1;
+		}
+		result <<= 1;
+		if (bignum_compare(&remainder, d) >= 0) {
+			bignum_sub(&remainder, d);
+			result |= 1;
+		}
+	}
+	return result;
+}
+
+/* NOTE: ceil(log2(5^e)) for e > 0, 1 for e == 0; must match util.c */
+function s32
+ryu_pow5_bits(s32 e)
+{
+	return (s32)(((u32)e * 1217359) >> 19) + 1;
+}
+
+function void
+generate_float_tables_include(void)
+{
+	char *output_name = "out/float_tables_inc.h";
+	FILE *fp = fopen(output_name, "w");
+	if (fp == NULL) {
+		printf("Failed to open output table file: %s\n", output_name);
+		exit(1);
+	}
+
+	fprintf(fp, "/* See LICENSE for copyright details */\n\n");
+	fprintf(fp, "// GENERATED CODE\n\n");
+	fprintf(fp, "#define POW10_U128_MIN_EXPONENT (%d)\n", POW10_U128_MIN_EXPONENT);
+	fprintf(fp, "#define POW10_U128_MAX_EXPONENT (%d)\n\n", POW10_U128_MAX_EXPONENT);
+
+	fprintf(fp, "/* NOTE: {lo, hi} */\n");
+	fprintf(fp, "read_only global u128 pow10_u128_table[] = {\n");
+	for (s32 e = POW10_U128_MIN_EXPONENT; e <= POW10_U128_MAX_EXPONENT; e++) {
+		u128 p = pow10_u128(e);
+		fprintf(fp, "\t{0x%016llXull, 0x%016llXull}, /* 1e%d */\n",
+		        (unsigned long long)p.lo, (unsigned long long)p.hi, e);
+	}
+	fprintf(fp, "};\n\n");
+
+	/* NOTE: Ryu (https://github.com/ulfjack/ryu) tables for shortest f32 formatting */
+	fprintf(fp, "#define RYU_F32_POW5_INV_BITCOUNT %d\n", RYU_F32_POW5_INV_BITCOUNT);
+	fprintf(fp, "#define RYU_F32_POW5_BITCOUNT     %d\n\n", RYU_F32_POW5_BITCOUNT);
+
+	/* NOTE: floor(2^(pow5_bits(i) - 1 + POW5_INV_BITCOUNT) / 5^i) + 1 */
+	fprintf(fp, "read_only global u64 ryu_f32_pow5_inv_split[%d] = {\n", RYU_F32_POW5_INV_COUNT);
+	BigNum five = {.limbs = {1}, .count = 1};
+	for (s32 i = 0; i < RYU_F32_POW5_INV_COUNT; i++) {
+		u64 value = bignum_pow2_div(ryu_pow5_bits(i) - 1 + RYU_F32_POW5_INV_BITCOUNT, &five) + 1;
+		fprintf(fp, "\t0x%016llXull,\n", (unsigned long long)value);
+		bignum_mul_small(&five, 5);
+	}
+	fprintf(fp, "};\n\n");
+
+	/* NOTE: 5^i scaled to exactly POW5_BITCOUNT bits (rounded down) */
+	fprintf(fp, "read_only global u64 ryu_f32_pow5_split[%d] = {\n", RYU_F32_POW5_COUNT);
+	five = (BigNum){.limbs = {1}, .count = 1};
+	for (s32 i = 0; i < RYU_F32_POW5_COUNT; i++) {
+		s32 shift = ryu_pow5_bits(i) - RYU_F32_POW5_BITCOUNT;
+		u64 value = 0;
+		for (s32 bit = RYU_F32_POW5_BITCOUNT - 1; bit >= 0; bit--)
+			value = value << 1 | bignum_bit(&five, bit + shift);
+		fprintf(fp, "\t0x%016llXull,\n", (unsigned long long)value);
+		bignum_mul_small(&five, 5);
+	}
+	fprintf(fp, "};\n");
+
 	fclose(fp);
 }
 
@@ -164,17 +497,12 @@ main(void)
 	str8 smem = {.data = mem, .length = sizeof(mem)};
 
 	SetTraceLogLevel(LOG_NONE);
-	int font_sizes[] = { FONT_SIZE, FONT_SIZE/2 };
-	for (unsigned int i = 0; i < sizeof(font_sizes)/sizeof(*font_sizes); i++) {
-		str8 tmem = smem;
-		str8 rmem = smem;
-		size_t tlen  = snprintf((char *)tmem.data, tmem.length, "out/lora_sb_%d_inc.h", i);
-		rmem.length -= (tlen + 1);
-		rmem.data   += (tlen + 1);
-		export_font_as_code("assets/Lora-SemiBold.ttf", (char *)tmem.data, font_sizes[i], rmem);
-	}
+	export_font_as_code("assets/Lora-SemiBold.ttf", "out/lora_sb_inc.h", FONT_SIZE, smem);
 
 	generate_shader_include(smem);
+	generate_srgb_lut_include();
+	generate_float_tables_include();
+	generate_icon_include();
 
 	return 0;
 }
@@ -1,15 +1,25 @@
 /* See LICENSE for copyright details */
+/* NOTE: POSIX/BSD/Linux interfaces (madvise, st_mtim, accept4) are hidden under -std=c11 */
+#define _GNU_SOURCE
 #include <raylib.h>
 #include <stdio.h>
 #include <stdlib.h>
 
 #include "util.c"
+#include "batch.c"
+#include "daemon.c"
+#include "icon_inc.h"
+
+#if !OS_WINDOWS
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 #ifdef _DEBUG
 #include <dlfcn.h>
-#include <fcntl.h>
 #include <sys/stat.h>
-#include <unistd.h>
 
 typedef struct timespec Filetime;
 
@@ -69,12 +79,126 @@ do_debug(void)
 
 global const char *argv0;
 
+/* NOTE: name of the object this process created; empty if it isn't publishing */
+global char shared_colour_name[64];
+
+/* NOTE: the object is only ever created, never opened, so that two pickers can't write
+ * the same single writer seqlock. While SHARED_COLOUR_NAME is taken by another picker
+ * this one publishes to SHARED_COLOUR_NAME.<pid> instead. Zero filled when created;
+ * version stays 0 until the first publish. */
+function SharedColour *
+open_shared_colour(void)
+{
+	SharedColour *result = 0;
+	#if !OS_WINDOWS
+	Stream name = {.data = (u8 *)shared_colour_name, .cap = countof(shared_colour_name) - 1};
+	stream_append_str8(&name, str8(SHARED_COLOUR_NAME));
+	s32 fd = shm_open(shared_colour_name, O_RDWR|O_CREAT|O_EXCL, 0600);
+	if (fd < 0 && errno == EEXIST) {
+		stream_append_byte(&name, '.');
+		stream_append_u64(&name, (u64)getpid());
+		fd = shm_open(shared_colour_name, O_RDWR|O_CREAT|O_EXCL, 0600);
+		if (fd >= 0) {
+			fprintf(stderr, "%s is in use, publishing the live colour to %s\n",
+			        SHARED_COLOUR_NAME, shared_colour_name);
+		}
+	}
+	if (fd >= 0) {
+		if (ftruncate(fd, sizeof(*result)) == 0) {
+			result = mmap(0, sizeof(*result), PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+			if (result == MAP_FAILED) result = 0;
+		}
+		if (!result) shm_unlink(shared_colour_name);
+		close(fd);
+	}
+	if (!result) shared_colour_name[0] = 0;
+	#endif
+	return result;
+}
+
+function void
+close_shared_colour(SharedColour *shared)
+{
+	#if !OS_WINDOWS
+	if (shared) {
+		munmap(shared, sizeof(*shared));
+		shm_unlink(shared_colour_name);
+	}
+	#endif
+}
+
+/* NOTE: composites the baked icon masks with the runtime colours, matching a radial
+ * gradient from colour to bg with a SELECTOR_BORDER_COLOUR ring on top */
+function void
+set_window_icon(v4 colour, Color bg)
+{
+	local_persist Color pixels[ICON_SIZE * ICON_SIZE];
+	Color centre = rl_colour_from_normalized(colour);
+	Color ring   = SELECTOR_BORDER_COLOUR;
+	for (u32 i = 0; i < countof(pixels); i++) {
+		f32 t = icon_gradient_weight[i] / 255.0f;
+		f32 a = icon_ring_coverage[i] / 255.0f * ring.a / 255.0f;
+		f32 r = bg.r + (centre.r - bg.r) * t;
+		f32 g = bg.g + (centre.g - bg.g) * t;
+		f32 b = bg.b + (centre.b - bg.b) * t;
+		pixels[i] = (Color){
+			.r = (u8)(r + (ring.r - r) * a + 0.5f),
+			.g = (u8)(g + (ring.g - g) * a + 0.5f),
+			.b = (u8)(b + (ring.b - b) * a + 0.5f),
+			.a = bg.a,
+		};
+	}
+
+	Image icon = {
+		.data    = pixels,
+		.width   = ICON_SIZE,
+		.height  = ICON_SIZE,
+		.mipmaps = 1,
+		.format  = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8,
+	};
+	SetWindowIcon(icon);
+}
+
+function void
+report_startup_profile(StartupProfile *p)
+{
+	local_persist str8 phase_names[StartupPhase_Last] = {
+		[StartupPhase_Window]     = str8("window:      "),
+		[StartupPhase_Icon]       = str8("icon:        "),
+		[StartupPhase_Font]       = str8("font upload: "),
+		[StartupPhase_Shader]     = str8("shader:      "),
+		[StartupPhase_FirstFrame] = str8("first frame: "),
+	};
+
+	u8 buffer[512];
+	Stream err = {.data = buffer, .cap = countof(buffer), .fd = 2};
+
+	f64 total = 0;
+	for (u32 i = 0; i < StartupPhase_Last; i++) {
+		stream_append_str8(&err, str8("startup: "));
+		stream_append_str8(&err, phase_names[i]);
+		stream_append_f64(&err, p->seconds[i] * 1e3, 1000);
+		stream_append_str8(&err, str8(" ms\n"));
+		total += p->seconds[i];
+	}
+	stream_append_str8(&err, str8("startup: total:       "));
+	stream_append_f64(&err, total * 1e3, 1000);
+	stream_append_str8(&err, str8(" ms\n"));
+	stream_flush(&err);
+}
+
 function no_return void
 usage(void)
 {
-	printf("usage: %s [-h ????????] [-r ?.??] [-g ?.??] [-b ?.??] [-a ?.??]\n"
+	printf("usage: %s [-h ????????] [-r ?.??] [-g ?.??] [-b ?.??] [-a ?.??] [-startup-profile]\n"
+	       "       %s -batch hex|rgba8|hsv8|hsv16|<rgb|hsv|oklab|oklch>[-f32] [file]\n"
+	       "       %s -daemon socket\n"
 	       "\t-h:          Hexadecimal Colour\n"
-	       "\t-r|-g|-b|-a: Floating Point Colour Value\n", argv0);
+	       "\t-r|-g|-b|-a: Floating Point Colour Value\n"
+	       "\t-batch:      Convert colours from file or stdin (one per line) without a window\n"
+	       "\t-daemon:     Serve conversion requests on a unix domain socket\n"
+	       "\t-startup-profile: Print the time spent in each startup phase to stderr\n",
+	       argv0, argv0, argv0);
 	exit(1);
 }
 
@@ -99,6 +223,9 @@ main(s32 argc, char *argv[])
 {
 	argv0 = argv[0];
 
+	StartupProfile startup_profile = {0};
+	b32 report_startup = 0;
+
 	ColourPickerCtx ctx = {
 		.window_size = { .w = 640, .h = 860 },
 
@@ -138,6 +265,24 @@ main(s32 argc, char *argv[])
 		v4 rgb = hsv_to_rgb(ctx.colour);
 		for (s32 i = 1; i < argc; i++) {
 			if (argv[i][0] == '-') {
+				/* NOTE: checked first since it would otherwise be taken as -b */
+				if (str8_equal(str8_from_c_str(argv[i]), str8("-batch"))) {
+					BatchOutput output;
+					if (!batch_output_from_str8(str8_from_c_str(argv[i + 1]), &output)) {
+						printf("invalid batch output: %s\n", argv[i + 1] ? argv[i + 1] : "");
+						usage();
+					}
+					return run_batch(output, 0, argv[i + 2]);
+				}
+				if (str8_equal(str8_from_c_str(argv[i]), str8("-daemon"))) {
+					if (argv[i + 1] == 0)
+						usage();
+					return run_daemon(argv[i + 1]);
+				}
+				if (str8_equal(str8_from_c_str(argv[i]), str8("-startup-profile"))) {
+					report_startup = 1;
+					continue;
+				}
 				if (argv[i][1] == 'v') {
 					printf("colour picker %s\n", VERSION);
 					return 0;
@@ -176,29 +321,24 @@ main(s32 argc, char *argv[])
 	SetTraceLogLevel(LOG_NONE);
 	#endif
 
+	startup_profile.last_mark = os_get_time();
+	ctx.startup_profile       = &startup_profile;
+
 	SetConfigFlags(FLAG_VSYNC_HINT);
 	InitWindow(ctx.window_size.w, ctx.window_size.h, "Colour Picker");
 	/* NOTE: do this after initing so that the window starts out floating in tiling wm */
 	SetWindowMinSize(324, 324 * WINDOW_ASPECT_RATIO);
 	SetWindowState(FLAG_WINDOW_RESIZABLE);
+	startup_profile_mark(&startup_profile, StartupPhase_Window);
 
-	{
-		Image icon;
-		RenderTexture icon_texture = LoadRenderTexture(128, 128);
-		BeginDrawing();
-		BeginTextureMode(icon_texture);
-		ClearBackground(ctx.bg);
-		DrawCircleGradient(64, 64, 48, rl_colour_from_normalized(hsv_to_rgb(ctx.colour)), ctx.bg);
-		DrawRing((Vector2){64, 64}, 45, 48, 0, 360, 128, SELECTOR_BORDER_COLOUR);
-		EndTextureMode();
-		EndDrawing();
-		icon = LoadImageFromTexture(icon_texture.texture);
-		SetWindowIcon(icon);
-		UnloadRenderTexture(icon_texture);
-		UnloadImage(icon);
-	}
+	set_window_icon(hsv_to_rgb(ctx.colour), ctx.bg);
+	startup_profile_mark(&startup_profile, StartupPhase_Icon);
+
+	ctx.font.atlas = LoadFont_lora_sb_inc();
+	ctx.font.scale = 1;
+	startup_profile_mark(&startup_profile, StartupPhase_Font);
 
-	ctx.font = LoadFont_lora_sb_0_inc();
+	ctx.shared_colour = open_shared_colour();
 
 	while(!WindowShouldClose()) {
 		do_debug();
@@ -207,18 +347,36 @@ main(s32 argc, char *argv[])
 		ClearBackground(ctx.bg);
 		do_colour_picker(&ctx, GetFrameTime(), (Vector2){0}, GetMousePosition());
 		EndDrawing();
-	}
 
-	v4 rgba = {0};
-	switch (ctx.stored_colour_kind) {
-	case ColourKind_RGB: rgba = ctx.colour;             break;
-	case ColourKind_HSV: rgba = hsv_to_rgb(ctx.colour); break;
-	InvalidDefaultCase;
+		if (ctx.startup_profile) {
+			startup_profile_mark(ctx.startup_profile, StartupPhase_FirstFrame);
+			if (report_startup) report_startup_profile(ctx.startup_profile);
+			ctx.startup_profile = 0;
+		}
 	}
-
-	u32 packed_rgba = pack_rl_colour(rl_colour_from_normalized(rgba));
-	printf("0x%08X|{.r = %0.03f, .g = %0.03f, .b = %0.03f, .a = %0.03f}\n",
-	       packed_rgba, rgba.r, rgba.g, rgba.b, rgba.a);
-
-	return 0;
+	close_shared_colour(ctx.shared_colour);
+
+	v4 rgba = convert_colour(ctx.colour, ctx.stored_colour_kind, ColourKind_RGB);
+
+	u8 buffer[128];
+	Stream out = {.data = buffer, .cap = countof(buffer), .fd = 1};
+
+	/* NOTE: upper case hex; letters are the only characters with 0x40 set */
+	u64 hex = hex_chars_from_u32(pack_rl_colour(rl_colour_from_normalized(rgba)));
+	hex &= ~((hex & 0x4040404040404040ull) >> 1);
+
+	stream_append_str8(&out, str8("0x"));
+	stream_append(&out, &hex, sizeof(hex));
+	stream_append_str8(&out, str8("|{.r = "));
+	stream_append_f64(&out, rgba.r, 1000);
+	stream_append_str8(&out, str8(", .g = "));
+	stream_append_f64(&out, rgba.g, 1000);
+	stream_append_str8(&out, str8(", .b = "));
+	stream_append_f64(&out, rgba.b, 1000);
+	stream_append_str8(&out, str8(", .a = "));
+	stream_append_f64(&out, rgba.a, 1000);
+	stream_append_str8(&out, str8("}\n"));
+	stream_flush(&out);
+
+	return out.errors;
 }
@@ -125,11 +125,145 @@ ctz_u64(u64 a)
 
 #endif /* !COMPILER_MSVC */
 
+function force_inline u32
+byte_swap_u32(u32 a)
+{
+	#if COMPILER_MSVC
+	u32 result = _byteswap_ulong(a);
+	#else
+	u32 result = __builtin_bswap32(a);
+	#endif
+	return result;
+}
+
+/* NOTE: full 64 x 64 -> 128 bit product */
+function force_inline u128
+mul_u64(u64 a, u64 b)
+{
+	u128 result;
+	#if COMPILER_MSVC && ARCH_X64
+	result.lo = _umul128(a, b, &result.hi);
+	#elif COMPILER_MSVC
+	result.lo = a * b;
+	result.hi = __umulh(a, b);
+	#else
+	unsigned __int128 p = (unsigned __int128)a * b;
+	result.lo = (u64)p;
+	result.hi = (u64)(p >> 64);
+	#endif
+	return result;
+}
+
+////////////////////////////
+// NOTE: Memory Functions
+
+/* NOTE: unaligned scalar and 16 byte loads/stores; these compile down to single moves */
+#define MEMORY_UNALIGNED_OPS(type) \
+function force_inline type \
+load_##type##_unaligned(void *p) \
+{ \
+	type result; \
+	MEMORY_LOAD_UNALIGNED(result, type, p); \
+	return result; \
+} \
+function force_inline void \
+store_##type##_unaligned(void *p, type v) \
+{ \
+	MEMORY_STORE_UNALIGNED(p, type, v); \
+}
+
+#if COMPILER_MSVC
+  #define MEMORY_LOAD_UNALIGNED(r, type, p)  (r) = *(type __unaligned *)(p)
+  #define MEMORY_STORE_UNALIGNED(p, type, v) *(type __unaligned *)(p) = (v)
+#else
+  #define MEMORY_LOAD_UNALIGNED(r, type, p)  __builtin_memcpy(&(r), (p), sizeof(type))
+  #define MEMORY_STORE_UNALIGNED(p, type, v) __builtin_memcpy((p), &(v), sizeof(type))
+#endif
+
+MEMORY_UNALIGNED_OPS(u16)
+MEMORY_UNALIGNED_OPS(u32)
+MEMORY_UNALIGNED_OPS(u64)
+
+/* NOTE: u8x16 is used for small sizes; memory_chunk is the widest register used by
+ * the loops over larger sizes */
+#if ARCH_X64
+  typedef __m128i u8x16;
+  #define load_u8x16_unaligned(p)      _mm_loadu_si128((__m128i *)(p))
+  #define store_u8x16_unaligned(p, v)  _mm_storeu_si128((__m128i *)(p), (v))
+  #define set1_u8x16(b)                _mm_set1_epi8((char)(b))
+#elif ARCH_ARM64
+  typedef uint8x16_t u8x16;
+  #define load_u8x16_unaligned(p)      vld1q_u8((u8 *)(p))
+  #define store_u8x16_unaligned(p, v)  vst1q_u8((u8 *)(p), (v))
+  #define set1_u8x16(b)                vdupq_n_u8((u8)(b))
+#endif
+
+#if ARCH_X64 && defined(__AVX__)
+  typedef __m256i memory_chunk;
+  #define MEMORY_CHUNK_SIZE        32
+  #define memory_chunk_load(p)     _mm256_loadu_si256((__m256i *)(p))
+  #define memory_chunk_store(p, v) _mm256_storeu_si256((__m256i *)(p), (v))
+  #define memory_chunk_set1(b)     _mm256_set1_epi8((char)(b))
+#else
+  typedef u8x16 memory_chunk;
+  #define MEMORY_CHUNK_SIZE        16
+  #define memory_chunk_load(p)     load_u8x16_unaligned(p)
+  #define memory_chunk_store(p, v) store_u8x16_unaligned(p, v)
+  #define memory_chunk_set1(b)     set1_u8x16(b)
+#endif
+
+/* NOTE: sizes up to 32 bytes; everything is loaded before anything is stored (the head
+ * and tail loads overlap instead of looping) so this is also safe for overlapping moves */
+function force_inline void
+memory_copy_small(u8 *d, u8 *s, s64 size)
+{
+	if (size >= 16) {
+		u8x16 head = load_u8x16_unaligned(s), tail = load_u8x16_unaligned(s + size - 16);
+		store_u8x16_unaligned(d, head);
+		store_u8x16_unaligned(d + size - 16, tail);
+	} else if (size >= 8) {
+		u64 head = load_u64_unaligned(s), tail = load_u64_unaligned(s + size - 8);
+		store_u64_unaligned(d, head);
+		store_u64_unaligned(d + size - 8, tail);
+	} else if (size >= 4) {
+		u32 head = load_u32_unaligned(s), tail = load_u32_unaligned(s + size - 4);
+		store_u32_unaligned(d, head);
+		store_u32_unaligned(d + size - 4, tail);
+	} else if (size >= 2) {
+		u16 head = load_u16_unaligned(s), tail = load_u16_unaligned(s + size - 2);
+		store_u16_unaligned(d, head);
+		store_u16_unaligned(d + size - 2, tail);
+	} else if (size == 1) {
+		*d = *s;
+	}
+}
+
 function void *
 memory_clear(void *restrict destination, u8 byte, s64 size)
 {
 	u8 *p = destination;
-	while (size > 0) p[--size] = byte;
+	if (size >= MEMORY_CHUNK_SIZE) {
+		memory_chunk v = memory_chunk_set1(byte);
+		for (s64 i = 0; i < size - MEMORY_CHUNK_SIZE; i += MEMORY_CHUNK_SIZE)
+			memory_chunk_store(p + i, v);
+		memory_chunk_store(p + size - MEMORY_CHUNK_SIZE, v);
+	} else if (size >= 16) {
+		u8x16 v = set1_u8x16(byte);
+		store_u8x16_unaligned(p, v);
+		store_u8x16_unaligned(p + size - 16, v);
+	} else if (size > 0) {
+		u64 v = 0x0101010101010101ull * byte;
+		if (size >= 8) {
+			store_u64_unaligned(p, v);
+			store_u64_unaligned(p + size - 8, v);
+		} else if (size >= 4) {
+			u32 v32 = (u32)v;
+			store_u32_unaligned(p, v32);
+			store_u32_unaligned(p + size - 4, v32);
+		} else {
+			p[0] = p[size / 2] = p[size - 1] = byte;
+		}
+	}
 	return p;
 }
 
@@ -137,7 +271,43 @@ function void
 memory_copy(void *restrict destination, void *restrict source, s64 size)
 {
 	u8 *s = source, *d = destination;
-	for (; size > 0; size--) *d++ = *s++;
+	if (size <= 32) {
+		memory_copy_small(d, s, size);
+	} else if (size <= 2 * MEMORY_CHUNK_SIZE) {
+		memory_chunk head = memory_chunk_load(s), tail = memory_chunk_load(s + size - MEMORY_CHUNK_SIZE);
+		memory_chunk_store(d, head);
+		memory_chunk_store(d + size - MEMORY_CHUNK_SIZE, tail);
+	} else {
+		memory_chunk tail = memory_chunk_load(s + size - MEMORY_CHUNK_SIZE);
+		for (s64 i = 0; i < size - MEMORY_CHUNK_SIZE; i += MEMORY_CHUNK_SIZE)
+			memory_chunk_store(d + i, memory_chunk_load(s + i));
+		memory_chunk_store(d + size - MEMORY_CHUNK_SIZE, tail);
+	}
+}
+
+/* NOTE: like memory_copy but source and destination may overlap */
+function void
+memory_move(void *destination, void *source, s64 size)
+{
+	u8 *s = source, *d = destination;
+	if (size <= 32) {
+		memory_copy_small(d, s, size);
+	} else if (size <= 2 * MEMORY_CHUNK_SIZE) {
+		memory_chunk head = memory_chunk_load(s), tail = memory_chunk_load(s + size - MEMORY_CHUNK_SIZE);
+		memory_chunk_store(d, head);
+		memory_chunk_store(d + size - MEMORY_CHUNK_SIZE, tail);
+	} else if (d <= s || d >= s + size) {
+		/* NOTE: forward; each chunk is loaded before any store can reach it */
+		memory_chunk tail = memory_chunk_load(s + size - MEMORY_CHUNK_SIZE);
+		for (s64 i = 0; i < size - MEMORY_CHUNK_SIZE; i += MEMORY_CHUNK_SIZE)
+			memory_chunk_store(d + i, memory_chunk_load(s + i));
+		memory_chunk_store(d + size - MEMORY_CHUNK_SIZE, tail);
+	} else {
+		memory_chunk head = memory_chunk_load(s);
+		for (s64 i = size - MEMORY_CHUNK_SIZE; i > 0; i -= MEMORY_CHUNK_SIZE)
+			memory_chunk_store(d + i, memory_chunk_load(s + i));
+		memory_chunk_store(d, head);
+	}
 }
 
 function force_inline s64
@@ -179,4 +349,13 @@ str8_from_c_str(char *s)
 	return result;
 }
 
+function b32
+str8_equal(str8 a, str8 b)
+{
+	b32 result = a.length == b.length;
+	for (s64 i = 0; result && i < a.length; i++)
+		result = a.data[i] == b.data[i];
+	return result;
+}
+
 #endif /* RSTD_CORE_H */
@@ -36,6 +36,13 @@
     #define cpu_yield()  __yield()
   #endif
 
+  #define atomic_load_u32(ptr)          (*(volatile u32 *)(ptr))
+  #define atomic_load_u64(ptr)          (*(volatile u64 *)(ptr))
+  #define atomic_store_u32(ptr, n)      (*(volatile u32 *)(ptr) = (n))
+  #define atomic_store_u64(ptr, n)      (*(volatile u64 *)(ptr) = (n))
+  #define atomic_cas_u64(ptr, cptr, n)  atomic_cas_u64_msvc((volatile __int64 *)(ptr), (__int64 *)(cptr), (__int64)(n))
+  #define store_fence()                 _WriteBarrier()
+
 #else /* !COMPILER_MSVC */
 
   #define alignas(n)     __attribute__((aligned(n)))
@@ -51,6 +58,15 @@
   #endif
   #define unreachable()  __builtin_unreachable()
 
+  #define atomic_load_u32(ptr)          __atomic_load_n(ptr, __ATOMIC_ACQUIRE)
+  #define atomic_load_u64(ptr)          __atomic_load_n(ptr, __ATOMIC_ACQUIRE)
+  #define atomic_store_u32(ptr, n)      __atomic_store_n(ptr, n, __ATOMIC_RELEASE)
+  #define atomic_store_u64(ptr, n)      __atomic_store_n(ptr, n, __ATOMIC_RELEASE)
+  /* NOTE: on failure *(cptr) is updated with the current value */
+  #define atomic_cas_u64(ptr, cptr, n)  __atomic_compare_exchange_n(ptr, cptr, n, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+  /* NOTE: earlier loads/stores can't be reordered past any later store */
+  #define store_fence()                 __atomic_thread_fence(__ATOMIC_RELEASE)
+
   #if ARCH_ARM64
     /* TODO(rnp)? debuggers just loop here forever and need a manual PC increment (step over) */
     #define debugbreak() asm volatile ("brk 0xf000")
@@ -62,7 +78,23 @@
 #endif /* !COMPILER_MSVC */
 
 #if ARCH_X64
+  #include <immintrin.h>
   #define cpu_yield()    _mm_pause()
+#elif ARCH_ARM64
+  #include <arm_neon.h>
+#endif
+
+#if COMPILER_MSVC
+#include <intrin.h>
+/* NOTE: matches __atomic_compare_exchange_n; on failure *expected gets the current value */
+static force_inline int
+atomic_cas_u64_msvc(volatile __int64 *ptr, __int64 *expected, __int64 n)
+{
+	__int64 old    = _InterlockedCompareExchange64(ptr, n, *expected);
+	int     result = old == *expected;
+	*expected      = old;
+	return result;
+}
 #endif
 
 #endif /* RSTD_INTRINSICS_H */
@@ -34,6 +34,8 @@ typedef double f64;
 typedef s64    sptr;
 typedef u64    uptr;
 
+typedef struct {u64 lo, hi;} u128;
+
 #define U64_MAX (0xFFFFFFFFFFFFFFFFull)
 #define U32_MAX (0xFFFFFFFFul)
 #define U16_MAX (0xFFFFu)
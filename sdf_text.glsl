@@ -0,0 +1,23 @@
+/* See LICENSE for copyright details */
+#version 330
+
+in vec2 fragTexCoord;
+in vec4 fragColor;
+
+uniform sampler2D texture0;
+uniform vec4      colDiffuse;
+
+out vec4 out_colour;
+
+/* NOTE: must match raylib's FONT_SDF_ON_EDGE_VALUE (128) */
+#define SDF_ON_EDGE 0.5
+
+void main()
+{
+	/* NOTE: the atlas alpha holds the distance to the glyph edge; the screen space rate of
+	 * change gives a one pixel wide antialiased edge at any draw size */
+	float distance = texture(texture0, fragTexCoord).a - SDF_ON_EDGE;
+	float width    = length(vec2(dFdx(distance), dFdy(distance)));
+	float alpha    = smoothstep(-width, width, distance);
+	out_colour     = vec4(fragColor.rgb, fragColor.a * alpha) * colDiffuse;
+}
@@ -13,6 +13,12 @@ out vec4 out_colour;
 
 #define CM_RGB      0
 #define CM_HSV      1
+#define CM_OKLAB    2
+#define CM_OKLCH    3
+
+/* NOTE: must match util.c */
+#define OKLAB_AB_RANGE 0.8
+#define OKLCH_C_RANGE  0.4
 
 uniform int   u_mode;
 uniform int   u_colour_mode;
@@ -30,6 +36,36 @@ vec3 hsv2rgb(vec3 hsv)
 	return hsv.z - hsv.z * hsv.y * k;
 }
 
+/* input:  linear sRGB (clipped to [0,1]) *
+ * output: sRGB [0,1]                     */
+vec3 linear2srgb(vec3 c)
+{
+	c = clamp(c, 0.0, 1.0);
+	return mix(12.92 * c, 1.055 * pow(c, vec3(1 / 2.4)) - 0.055, step(0.0031308, c));
+}
+
+/* input:  L [0,1] | a,b [-OKLAB_AB_RANGE/2, OKLAB_AB_RANGE/2] *
+ * output: rgb [0,1]                                           */
+vec3 oklab2rgb(vec3 lab)
+{
+	vec3 lms = vec3(dot(vec3(1,  0.3963377774,  0.2158037573), lab),
+	                dot(vec3(1, -0.1055613458, -0.0638541728), lab),
+	                dot(vec3(1, -0.0894841775, -1.2914855480), lab));
+	lms = lms * lms * lms;
+	vec3 rgb = vec3(dot(vec3( 4.0767416621, -3.3077115913,  0.2309699292), lms),
+	                dot(vec3(-1.2684380046,  2.6097574011, -0.3413193965), lms),
+	                dot(vec3(-0.0041960863, -0.7034186147,  1.7076147010), lms));
+	return linear2srgb(rgb);
+}
+
+/* input:  L [0,1] | C [0, OKLCH_C_RANGE] | h [0, 1] turns *
+ * output: rgb [0,1]                                      */
+vec3 oklch2rgb(vec3 lch)
+{
+	float angle = 6.28318531 * lch.z;
+	return oklab2rgb(vec3(lch.x, lch.y * cos(angle), lch.y * sin(angle)));
+}
+
 bool in_rounded_region(vec2 pos, vec4 min_max, float radius)
 {
 	vec2 min_xy = min_max.xy;
@@ -115,6 +151,14 @@ vec4 slider_mode(vec2 pos)
 	switch (u_colour_mode) {
 	case CM_RGB: break;
 	case CM_HSV: result.x *= 360; result = vec4(hsv2rgb(result.xyz), result.w); break;
+	case CM_OKLAB: {
+		vec3 lab = vec3(result.x, (result.yz - 0.5) * OKLAB_AB_RANGE);
+		result   = vec4(oklab2rgb(lab), result.w);
+	} break;
+	case CM_OKLCH: {
+		vec3 lch = vec3(result.x, result.y * OKLCH_C_RANGE, result.z);
+		result   = vec4(oklch2rgb(lch), result.w);
+	} break;
 	}
 
 	return result;
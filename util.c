@@ -7,12 +7,29 @@
 #include "rstd_types.h"
 #include "rstd_core.h"
 
-#include "lora_sb_0_inc.h"
-#include "lora_sb_1_inc.h"
+#include "lora_sb_inc.h"
 #include "shader_inc.h"
+#include "srgb_lut_inc.h"
+#include "float_tables_inc.h"
 #include "config.h"
 
-#define fmod_f32(a, b) __builtin_fmodf((a), (b))
+/* NOTE: config.h files made before the SDF font existed */
+#ifndef SDF_TEXT_SHADER_NAME
+#define SDF_TEXT_SHADER_NAME "sdf_text.glsl"
+#endif
+
+#include <stdlib.h>
+#include <time.h>
+
+#if OS_WINDOWS
+#include <io.h>
+/* NOTE: declared here since windows.h collides with raylib */
+__declspec(dllimport) s32 __stdcall QueryPerformanceCounter(u64 *count);
+__declspec(dllimport) s32 __stdcall QueryPerformanceFrequency(u64 *frequency);
+#else
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
 
 #if ARCH_ARM64
 function force_inline u64
@@ -33,6 +50,172 @@ rdtsc(void)
 #define DEBUG_EXPORT function
 #endif
 
+/* NOTE: f32 vector lanes at the widest width the target was compiled for. Batch kernels
+ * are written once against these; comparisons produce all ones/all zeros lane masks */
+#if ARCH_X64 && defined(__AVX2__)
+  #define F32_LANES 8
+  typedef __m256 f32xN;
+  #define set1_f32xN(a)         _mm256_set1_ps(a)
+  #define load_f32xN(p)         _mm256_loadu_ps(p)
+  #define store_f32xN(p, a)     _mm256_storeu_ps(p, a)
+  #define add_f32xN(a, b)       _mm256_add_ps(a, b)
+  #define sub_f32xN(a, b)       _mm256_sub_ps(a, b)
+  #define mul_f32xN(a, b)       _mm256_mul_ps(a, b)
+  #define div_f32xN(a, b)       _mm256_div_ps(a, b)
+  #define min_f32xN(a, b)       _mm256_min_ps(a, b)
+  #define max_f32xN(a, b)       _mm256_max_ps(a, b)
+  #define floor_f32xN(a)        _mm256_floor_ps(a)
+  #define equal_f32xN(a, b)     _mm256_cmp_ps(a, b, _CMP_EQ_OQ)
+  #define greater_f32xN(a, b)   _mm256_cmp_ps(a, b, _CMP_GT_OQ)
+  #define select_f32xN(m, a, b) _mm256_blendv_ps(b, a, m)
+  #define sqrt_f32xN(a)         _mm256_sqrt_ps(a)
+  #define and_f32xN(a, b)       _mm256_and_ps(a, b)
+  #define xor_f32xN(a, b)       _mm256_xor_ps(a, b)
+  typedef __m256i s32xN;
+  #define set1_s32xN(a)         _mm256_set1_epi32(a)
+  #define load_s32xN(p)         _mm256_loadu_si256((__m256i *)(p))
+  #define store_s32xN(p, a)     _mm256_storeu_si256((__m256i *)(p), a)
+  #define add_s32xN(a, b)       _mm256_add_epi32(a, b)
+  #define sub_s32xN(a, b)       _mm256_sub_epi32(a, b)
+  #define mul_s32xN(a, b)       _mm256_mullo_epi32(a, b)
+  #define and_s32xN(a, b)       _mm256_and_si256(a, b)
+  #define or_s32xN(a, b)        _mm256_or_si256(a, b)
+  #define shl_s32xN(a, n)       _mm256_slli_epi32(a, n)
+  #define shr_s32xN(a, n)       _mm256_srli_epi32(a, n)
+  #define s32xN_from_f32xN(a)   _mm256_cvttps_epi32(a)
+  #define f32xN_from_s32xN(a)   _mm256_cvtepi32_ps(a)
+  #define bits_s32xN(a)         _mm256_castps_si256(a)
+  #define bits_f32xN(a)         _mm256_castsi256_ps(a)
+#elif ARCH_X64
+  #define F32_LANES 4
+  typedef __m128 f32xN;
+  #define set1_f32xN(a)         _mm_set1_ps(a)
+  #define load_f32xN(p)         _mm_loadu_ps(p)
+  #define store_f32xN(p, a)     _mm_storeu_ps(p, a)
+  #define add_f32xN(a, b)       _mm_add_ps(a, b)
+  #define sub_f32xN(a, b)       _mm_sub_ps(a, b)
+  #define mul_f32xN(a, b)       _mm_mul_ps(a, b)
+  #define div_f32xN(a, b)       _mm_div_ps(a, b)
+  #define min_f32xN(a, b)       _mm_min_ps(a, b)
+  #define max_f32xN(a, b)       _mm_max_ps(a, b)
+  #define equal_f32xN(a, b)     _mm_cmpeq_ps(a, b)
+  #define greater_f32xN(a, b)   _mm_cmpgt_ps(a, b)
+  #define select_f32xN(m, a, b) _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b))
+  #define sqrt_f32xN(a)         _mm_sqrt_ps(a)
+  #define and_f32xN(a, b)       _mm_and_ps(a, b)
+  #define xor_f32xN(a, b)       _mm_xor_ps(a, b)
+  typedef __m128i s32xN;
+  #define set1_s32xN(a)         _mm_set1_epi32(a)
+  #define load_s32xN(p)         _mm_loadu_si128((__m128i *)(p))
+  #define store_s32xN(p, a)     _mm_storeu_si128((__m128i *)(p), a)
+  #define add_s32xN(a, b)       _mm_add_epi32(a, b)
+  #define sub_s32xN(a, b)       _mm_sub_epi32(a, b)
+  #define and_s32xN(a, b)       _mm_and_si128(a, b)
+  #define or_s32xN(a, b)        _mm_or_si128(a, b)
+  #define shl_s32xN(a, n)       _mm_slli_epi32(a, n)
+  #define shr_s32xN(a, n)       _mm_srli_epi32(a, n)
+  #define s32xN_from_f32xN(a)   _mm_cvttps_epi32(a)
+  #define f32xN_from_s32xN(a)   _mm_cvtepi32_ps(a)
+  #define bits_s32xN(a)         _mm_castps_si128(a)
+  #define bits_f32xN(a)         _mm_castsi128_ps(a)
+  #if defined(__SSE4_1__)
+    #define floor_f32xN(a)      _mm_floor_ps(a)
+    #define mul_s32xN(a, b)     _mm_mullo_epi32(a, b)
+  #else
+    #define floor_f32xN(a)      floor_f32x4_sse2(a)
+    #define mul_s32xN(a, b)     mul_s32x4_sse2(a, b)
+  #endif
+#elif ARCH_ARM64
+  #define F32_LANES 4
+  typedef float32x4_t f32xN;
+  #define set1_f32xN(a)         vdupq_n_f32(a)
+  #define load_f32xN(p)         vld1q_f32(p)
+  #define store_f32xN(p, a)     vst1q_f32(p, a)
+  #define add_f32xN(a, b)       vaddq_f32(a, b)
+  #define sub_f32xN(a, b)       vsubq_f32(a, b)
+  #define mul_f32xN(a, b)       vmulq_f32(a, b)
+  #define div_f32xN(a, b)       vdivq_f32(a, b)
+  #define min_f32xN(a, b)       vminq_f32(a, b)
+  #define max_f32xN(a, b)       vmaxq_f32(a, b)
+  #define floor_f32xN(a)        vrndmq_f32(a)
+  #define equal_f32xN(a, b)     vreinterpretq_f32_u32(vceqq_f32(a, b))
+  #define greater_f32xN(a, b)   vreinterpretq_f32_u32(vcgtq_f32(a, b))
+  #define select_f32xN(m, a, b) vbslq_f32(vreinterpretq_u32_f32(m), a, b)
+  #define sqrt_f32xN(a)         vsqrtq_f32(a)
+  #define and_f32xN(a, b)       vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b)))
+  #define xor_f32xN(a, b)       vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b)))
+  typedef int32x4_t s32xN;
+  #define set1_s32xN(a)         vdupq_n_s32(a)
+  #define load_s32xN(p)         vld1q_s32((s32 *)(p))
+  #define store_s32xN(p, a)     vst1q_s32((s32 *)(p), a)
+  #define add_s32xN(a, b)       vaddq_s32(a, b)
+  #define sub_s32xN(a, b)       vsubq_s32(a, b)
+  #define mul_s32xN(a, b)       vmulq_s32(a, b)
+  #define and_s32xN(a, b)       vandq_s32(a, b)
+  #define or_s32xN(a, b)        vorrq_s32(a, b)
+  #define shl_s32xN(a, n)       vshlq_n_s32(a, n)
+  #define shr_s32xN(a, n)       vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(a), n))
+  #define s32xN_from_f32xN(a)   vcvtq_s32_f32(a)
+  #define f32xN_from_s32xN(a)   vcvtq_f32_s32(a)
+  #define bits_s32xN(a)         vreinterpretq_s32_f32(a)
+  #define bits_f32xN(a)         vreinterpretq_f32_s32(a)
+#endif
+
+#if ARCH_X64 && !defined(__AVX2__) && !defined(__SSE4_1__)
+/* NOTE: truncate then step down wherever truncation rounded up (negative inputs) */
+function force_inline __m128
+floor_f32x4_sse2(__m128 a)
+{
+	__m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(a));
+	return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, a), _mm_set1_ps(1)));
+}
+
+/* NOTE: low 32 bits of each product; SSE2 only multiplies the even lanes */
+function force_inline __m128i
+mul_s32x4_sse2(__m128i a, __m128i b)
+{
+	__m128i even = _mm_mul_epu32(a, b);
+	__m128i odd  = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+	                          _mm_shuffle_epi32(odd,  _MM_SHUFFLE(0, 0, 2, 0)));
+}
+#endif
+
+/* NOTE: defines a structure-of-arrays kernel which converts 3 channels in place by running
+ * `lanes_fn` over F32_LANES colours at a time. The tail is padded out to a full vector
+ * rather than handled by separate scalar code so that single colours and large buffers
+ * always go through the exact same math. Alpha is never touched by a conversion. */
+typedef void colour_soa_kernel_fn(f32 *restrict, f32 *restrict, f32 *restrict, s64);
+#define COLOUR_SOA_KERNEL(name, lanes_fn) \
+function void \
+name(f32 *restrict x, f32 *restrict y, f32 *restrict z, s64 count) \
+{ \
+	s64 i = 0; \
+	for (; i + F32_LANES <= count; i += F32_LANES) { \
+		f32xN a = load_f32xN(x + i), b = load_f32xN(y + i), c = load_f32xN(z + i); \
+		lanes_fn(&a, &b, &c); \
+		store_f32xN(x + i, a); store_f32xN(y + i, b); store_f32xN(z + i, c); \
+	} \
+	if (i < count) { \
+		alignas(32) f32 tail[3][F32_LANES] = {0}; \
+		s64 size = (count - i) * (s64)sizeof(f32); \
+		memory_copy(tail[0], x + i, size); \
+		memory_copy(tail[1], y + i, size); \
+		memory_copy(tail[2], z + i, size); \
+		f32xN a = load_f32xN(tail[0]), b = load_f32xN(tail[1]), c = load_f32xN(tail[2]); \
+		lanes_fn(&a, &b, &c); \
+		store_f32xN(tail[0], a); store_f32xN(tail[1], b); store_f32xN(tail[2], c); \
+		memory_copy(x + i, tail[0], size); \
+		memory_copy(y + i, tail[1], size); \
+		memory_copy(z + i, tail[2], size); \
+	} \
+}
+
+/* NOTE: a Stream with fd > 0 is a buffered writer and is flushed to fd whenever it
+ * fills. fd == 0 (stdin is never an output) keeps everything in memory and sets errors
+ * once cap is exceeded. fd == STREAM_GROWABLE also keeps everything in memory but
+ * reallocs data (which must come from malloc) as it fills. */
+#define STREAM_GROWABLE (-1)
 typedef struct {
 	u8  *data;
 	u32 cap;
@@ -89,11 +272,50 @@ typedef struct {
 	str8 unparsed;
 } NumberConversion;
 
-typedef enum c{
-	ColourKind_RGB,
-	ColourKind_HSV,
+/* NOTE: arbitrary precision decimal used by number_from_str8 when the fast paths can't
+ * decide the rounding. Value is 0.digits * 10^point; digits are stored as 0-9. */
+#define DECIMAL_MAX_DIGITS 800
+typedef struct {
+	u8  digits[DECIMAL_MAX_DIGITS];
+	s32 count;
+	s32 point;
+	b32 truncated;
+} Decimal;
+
+/* NOTE: every kind is stored with each channel normalized to [0, 1]:
+ * HSV:   hue is in turns
+ * OKLab: a and b are offset and scaled by OKLAB_AB_RANGE
+ * OKLCH: chroma is scaled by OKLCH_C_RANGE and hue is in turns */
+/* NOTE: (kind, name, hub): the hub is the kind each kind is defined on; conversions
+ * only leave a hub when the two kinds are defined on different ones */
+#define COLOUR_KIND_LIST(X, ...) \
+	X(__VA_ARGS__, RGB,   rgb,   rgb)   \
+	X(__VA_ARGS__, HSV,   hsv,   rgb)   \
+	X(__VA_ARGS__, OKLab, oklab, oklab) \
+	X(__VA_ARGS__, OKLCH, oklch, oklab)
+
+/* NOTE: a macro can't expand itself so walking (from, to) pairs needs a second copy */
+#define COLOUR_KIND_LIST_INNER(X, ...) \
+	X(__VA_ARGS__, RGB,   rgb,   rgb)   \
+	X(__VA_ARGS__, HSV,   hsv,   rgb)   \
+	X(__VA_ARGS__, OKLab, oklab, oklab) \
+	X(__VA_ARGS__, OKLCH, oklch, oklab)
+
+#define COLOUR_KIND_ENUM(_, kind, name, hub) ColourKind_##kind,
+typedef enum {
+	COLOUR_KIND_LIST(COLOUR_KIND_ENUM, _)
 	ColourKind_Last,
 } ColourKind;
+#undef COLOUR_KIND_ENUM
+
+#define COLOUR_KIND_COUNT(_, kind, name, hub) + 1
+static_assert((0 COLOUR_KIND_LIST_INNER(COLOUR_KIND_COUNT, _)) == ColourKind_Last,
+              "COLOUR_KIND_LIST and COLOUR_KIND_LIST_INNER must match");
+#undef COLOUR_KIND_COUNT
+
+/* NOTE: these must match slider_lerp.glsl */
+#define OKLAB_AB_RANGE 0.8f
+#define OKLCH_C_RANGE  0.4f
 
 enum colour_picker_mode {
 	CPM_PICKER   = 0,
@@ -246,17 +468,59 @@ typedef struct {
 	Variable colour_kind_cycler;
 } SliderModeState;
 
+/* NOTE: the live colour, published to the POSIX shared memory object SHARED_COLOUR_NAME
+ * while the picker is open. Guarded by a seqlock: readers load sequence, copy the
+ * fields, and retry if sequence was odd or has changed when loaded again. */
+#define SHARED_COLOUR_NAME    "/colourpicker"
+#define SHARED_COLOUR_VERSION 1
+typedef struct {
+	u32 version;
+	u32 sequence;
+	v4  colour;      /* NOTE: as stored, see colour_kind */
+	v4  rgba;
+	u32 colour_kind;
+	u32 rgba8;       /* NOTE: 0xRRGGBBAA */
+	u8  hex[8];      /* NOTE: lower case RRGGBBAA, not NUL terminated */
+} SharedColour;
+
+typedef enum {
+	StartupPhase_Window,
+	StartupPhase_Icon,
+	StartupPhase_Font,
+	StartupPhase_Shader,
+	StartupPhase_FirstFrame,
+	StartupPhase_Last,
+} StartupPhase;
+
+/* NOTE: seconds spent in each phase before the first frame was presented */
+typedef struct {
+	f64 seconds[StartupPhase_Last];
+	f64 last_mark;
+} StartupProfile;
+
+/* NOTE: the embedded font is a single SDF atlas; it is drawn at atlas size * scale */
+typedef struct {
+	Font   atlas;
+	Shader shader;
+	f32    scale;
+} SDFFont;
+
 typedef struct {
 	v4 colour, previous_colour;
 	ColourStackState colour_stack;
 
+	SharedColour   *shared_colour;
+	StartupProfile *startup_profile;
+
 	uv2 window_size;
 	v2  window_pos;
 	v2  mouse_pos;
 	v2  last_mouse;
+	/* NOTE: relative to the mode textures, as of the last time one was drawn */
+	v2  last_mode_mouse;
 
-	Font  font;
-	Color bg, fg;
+	SDFFont font;
+	Color   bg, fg;
 
 	TextInputState   text_input_state;
 	InteractionState interaction;
@@ -289,42 +553,426 @@ typedef struct {
 
 #define IsHex(a) (IsDigit(a) || Between((a), 'a', 'f') || Between((a), 'A', 'F'))
 
+function force_inline void
+rgb_to_hsv_lanes(f32xN *x, f32xN *y, f32xN *z)
+{
+	f32xN r = *x, g = *y, b = *z;
+	f32xN zero = set1_f32xN(0);
+	f32xN one  = set1_f32xN(1);
+
+	f32xN M = max_f32xN(r, max_f32xN(g, b));
+	f32xN m = min_f32xN(r, min_f32xN(g, b));
+	f32xN C = sub_f32xN(M, m);
+
+	/* NOTE: compute every sector's hue and pick the one belonging to the max channel
+	 * (ties resolve R, G, B in that order); greys produce a hue and saturation of 0 */
+	f32xN chroma = greater_f32xN(C, zero);
+	f32xN inv_C  = div_f32xN(one, select_f32xN(chroma, C, one));
+	f32xN hr     = mul_f32xN(sub_f32xN(g, b), inv_C);
+	f32xN hg     = add_f32xN(mul_f32xN(sub_f32xN(b, r), inv_C), set1_f32xN(2));
+	f32xN hb     = add_f32xN(mul_f32xN(sub_f32xN(r, g), inv_C), set1_f32xN(4));
+	f32xN h      = select_f32xN(equal_f32xN(M, r), hr, select_f32xN(equal_f32xN(M, g), hg, hb));
+
+	/* NOTE: the red sector spans [-1, 1]; wrap into [0, 1) instead of calling fmod */
+	h = mul_f32xN(h, set1_f32xN(1.0f / 6.0f));
+	h = sub_f32xN(h, floor_f32xN(h));
+
+	f32xN s = div_f32xN(C, select_f32xN(greater_f32xN(M, zero), M, one));
+
+	*x = select_f32xN(chroma, h, zero);
+	*y = s;
+	*z = M;
+}
+
+function force_inline f32xN
+hsv_to_rgb_channel_lanes(f32xN h6, f32xN s, f32xN v, f32 n)
+{
+	/* NOTE: k = (n + 6h) mod 6 */
+	f32xN k = add_f32xN(h6, set1_f32xN(n));
+	k = sub_f32xN(k, mul_f32xN(floor_f32xN(mul_f32xN(k, set1_f32xN(1.0f / 6.0f))), set1_f32xN(6)));
+
+	f32xN t = min_f32xN(k, sub_f32xN(set1_f32xN(4), k));
+	t = max_f32xN(set1_f32xN(0), min_f32xN(set1_f32xN(1), t));
+
+	f32xN result = sub_f32xN(v, mul_f32xN(mul_f32xN(v, s), t));
+	return result;
+}
+
+function force_inline void
+hsv_to_rgb_lanes(f32xN *x, f32xN *y, f32xN *z)
+{
+	f32xN h6 = mul_f32xN(*x, set1_f32xN(6));
+	f32xN s  = *y, v = *z;
+	*x = hsv_to_rgb_channel_lanes(h6, s, v, 5);
+	*y = hsv_to_rgb_channel_lanes(h6, s, v, 3);
+	*z = hsv_to_rgb_channel_lanes(h6, s, v, 1);
+}
+
+COLOUR_SOA_KERNEL(rgb_to_hsv_soa, rgb_to_hsv_lanes)
+COLOUR_SOA_KERNEL(hsv_to_rgb_soa, hsv_to_rgb_lanes)
+
 function v4
 rgb_to_hsv(v4 rgb)
 {
-	v4 hsv = {0};
-	f32 M = Max(rgb.r, Max(rgb.g, rgb.b));
-	f32 m = Min(rgb.r, Min(rgb.g, rgb.b));
-	if (M - m > 0) {
-		f32 C = M - m;
-		if (M == rgb.r) {
-			hsv.x = fmod_f32((rgb.g - rgb.b) / C, 6) / 6.0;
-		} else if (M == rgb.g) {
-			hsv.x = ((rgb.b - rgb.r) / C + 2) / 6.0;
-		} else {
-			hsv.x = ((rgb.r - rgb.g) / C + 4) / 6.0;
-		}
-		hsv.y = M? C / M : 0;
-		hsv.z = M;
-		hsv.a = rgb.a;
-	}
+	v4 hsv = rgb;
+	rgb_to_hsv_soa(hsv.E + 0, hsv.E + 1, hsv.E + 2, 1);
 	return hsv;
 }
 
 function v4
 hsv_to_rgb(v4 hsv)
 {
-	v4 rgba;
-	f32 k  = fmod_f32(5 + hsv.x * 6, 6);
-	rgba.r = hsv.z - hsv.z * hsv.y * Max(0, Min(1, Min(k, 4 - k)));
-	k      = fmod_f32(3 + hsv.x * 6, 6);
-	rgba.g = hsv.z - hsv.z * hsv.y * Max(0, Min(1, Min(k, 4 - k)));
-	k      = fmod_f32(1 + hsv.x * 6, 6);
-	rgba.b = hsv.z - hsv.z * hsv.y * Max(0, Min(1, Min(k, 4 - k)));
-	rgba.a = hsv.a;
+	v4 rgba = hsv;
+	hsv_to_rgb_soa(rgba.E + 0, rgba.E + 1, rgba.E + 2, 1);
 	return rgba;
 }
 
+/* NOTE: transcendental helpers for the perceptual colour kinds. These are only as
+ * accurate as a colour conversion needs (~1e-6 relative) */
+function force_inline f32xN
+abs_f32xN(f32xN a)
+{
+	return and_f32xN(a, bits_f32xN(set1_s32xN(0x7FFFFFFF)));
+}
+
+function force_inline f32xN
+dot3_f32xN(f32xN a, f32xN b, f32xN c, f32 ka, f32 kb, f32 kc)
+{
+	f32xN result = mul_f32xN(a, set1_f32xN(ka));
+	result = add_f32xN(result, mul_f32xN(b, set1_f32xN(kb)));
+	result = add_f32xN(result, mul_f32xN(c, set1_f32xN(kc)));
+	return result;
+}
+
+/* NOTE: only valid for normal, positive x */
+function force_inline f32xN
+log2_f32xN(f32xN x)
+{
+	s32xN bits = bits_s32xN(x);
+	f32xN e    = f32xN_from_s32xN(sub_s32xN(shr_s32xN(bits, 23), set1_s32xN(127)));
+	f32xN m    = bits_f32xN(or_s32xN(and_s32xN(bits, set1_s32xN(0x007FFFFF)), set1_s32xN(0x3F800000)));
+
+	/* NOTE: centre the mantissa on 1 so that the series below converges quickly */
+	f32xN big = greater_f32xN(m, set1_f32xN(1.41421356f));
+	m = select_f32xN(big, mul_f32xN(m, set1_f32xN(0.5f)), m);
+	e = add_f32xN(e, and_f32xN(big, set1_f32xN(1)));
+
+	/* NOTE: ln(m) = 2 atanh(s) = 2 (s + s^3/3 + s^5/5 + ...), s = (m - 1) / (m + 1) */
+	f32xN s  = div_f32xN(sub_f32xN(m, set1_f32xN(1)), add_f32xN(m, set1_f32xN(1)));
+	f32xN s2 = mul_f32xN(s, s);
+	f32xN p  = set1_f32xN(1.0f / 9.0f);
+	p = add_f32xN(mul_f32xN(p, s2), set1_f32xN(1.0f / 7.0f));
+	p = add_f32xN(mul_f32xN(p, s2), set1_f32xN(1.0f / 5.0f));
+	p = add_f32xN(mul_f32xN(p, s2), set1_f32xN(1.0f / 3.0f));
+	p = add_f32xN(mul_f32xN(p, s2), set1_f32xN(1.0f));
+
+	f32xN result = add_f32xN(e, mul_f32xN(mul_f32xN(s, p), set1_f32xN(2.0f / 0.69314718f)));
+	return result;
+}
+
+function force_inline f32xN
+exp2_f32xN(f32xN x)
+{
+	x = max_f32xN(set1_f32xN(-126), min_f32xN(set1_f32xN(126), x));
+
+	f32xN n = floor_f32xN(add_f32xN(x, set1_f32xN(0.5f)));
+	f32xN t = mul_f32xN(sub_f32xN(x, n), set1_f32xN(0.69314718f));
+
+	/* NOTE: e^t for t in [-ln(2)/2, ln(2)/2] */
+	f32xN p = set1_f32xN(1.0f / 5040.0f);
+	p = add_f32xN(mul_f32xN(p, t), set1_f32xN(1.0f / 720.0f));
+	p = add_f32xN(mul_f32xN(p, t), set1_f32xN(1.0f / 120.0f));
+	p = add_f32xN(mul_f32xN(p, t), set1_f32xN(1.0f / 24.0f));
+	p = add_f32xN(mul_f32xN(p, t), set1_f32xN(1.0f / 6.0f));
+	p = add_f32xN(mul_f32xN(p, t), set1_f32xN(1.0f / 2.0f));
+	p = add_f32xN(mul_f32xN(p, t), set1_f32xN(1.0f));
+	p = add_f32xN(mul_f32xN(p, t), set1_f32xN(1.0f));
+
+	f32xN scale  = bits_f32xN(shl_s32xN(add_s32xN(s32xN_from_f32xN(n), set1_s32xN(127)), 23));
+	f32xN result = mul_f32xN(p, scale);
+	return result;
+}
+
+/* NOTE: x^y for x >= 0 */
+function force_inline f32xN
+pow_f32xN(f32xN x, f32 y)
+{
+	f32xN positive = greater_f32xN(x, set1_f32xN(0));
+	f32xN safe_x   = select_f32xN(positive, x, set1_f32xN(1));
+	f32xN result   = exp2_f32xN(mul_f32xN(log2_f32xN(safe_x), set1_f32xN(y)));
+	return select_f32xN(positive, result, set1_f32xN(0));
+}
+
+function force_inline f32xN
+cbrt_f32xN(f32xN x)
+{
+	f32xN a = abs_f32xN(x);
+	f32xN y = pow_f32xN(a, 1.0f / 3.0f);
+
+	/* NOTE: one newton step cleans up the error from the log/exp approximations */
+	f32xN y2 = mul_f32xN(y, y);
+	f32xN nz = greater_f32xN(y2, set1_f32xN(0));
+	f32xN d  = div_f32xN(sub_f32xN(mul_f32xN(y2, y), a),
+	                     mul_f32xN(set1_f32xN(3), select_f32xN(nz, y2, set1_f32xN(1))));
+	y = select_f32xN(nz, sub_f32xN(y, d), y);
+
+	f32xN result = xor_f32xN(y, and_f32xN(x, set1_f32xN(-0.0f)));
+	return result;
+}
+
+/* NOTE: atan2(y, x) in turns [0, 1) */
+function force_inline f32xN
+atan2_turns_f32xN(f32xN y, f32xN x)
+{
+	f32xN zero = set1_f32xN(0);
+	f32xN ax = abs_f32xN(x), ay = abs_f32xN(y);
+	f32xN mx = max_f32xN(ax, ay), mn = min_f32xN(ax, ay);
+	f32xN t  = div_f32xN(mn, select_f32xN(greater_f32xN(mx, zero), mx, set1_f32xN(1)));
+	f32xN t2 = mul_f32xN(t, t);
+
+	/* NOTE: minimax atan on [0, 1] */
+	f32xN p = set1_f32xN(-0.01172120f);
+	p = add_f32xN(mul_f32xN(p, t2), set1_f32xN( 0.05265332f));
+	p = add_f32xN(mul_f32xN(p, t2), set1_f32xN(-0.11643287f));
+	p = add_f32xN(mul_f32xN(p, t2), set1_f32xN( 0.19354346f));
+	p = add_f32xN(mul_f32xN(p, t2), set1_f32xN(-0.33262347f));
+	p = add_f32xN(mul_f32xN(p, t2), set1_f32xN( 0.99997726f));
+	f32xN r = mul_f32xN(t, p);
+
+	r = select_f32xN(greater_f32xN(ay, ax), sub_f32xN(set1_f32xN(1.57079633f), r), r);
+	r = select_f32xN(greater_f32xN(zero, x), sub_f32xN(set1_f32xN(3.14159265f), r), r);
+	r = select_f32xN(greater_f32xN(zero, y), sub_f32xN(zero, r), r);
+
+	f32xN result = mul_f32xN(r, set1_f32xN(1.0f / 6.28318531f));
+	result = sub_f32xN(result, floor_f32xN(result));
+	return result;
+}
+
+/* NOTE: sin(2 pi t) */
+function force_inline f32xN
+sin_turns_f32xN(f32xN t)
+{
+	/* NOTE: reduce to [-0.5, 0.5) then reflect into [-0.25, 0.25] */
+	t = sub_f32xN(t, floor_f32xN(add_f32xN(t, set1_f32xN(0.5f))));
+	t = select_f32xN(greater_f32xN(t, set1_f32xN(0.25f)), sub_f32xN(set1_f32xN(0.5f), t), t);
+	t = select_f32xN(greater_f32xN(set1_f32xN(-0.25f), t), sub_f32xN(set1_f32xN(-0.5f), t), t);
+
+	f32xN x  = mul_f32xN(t, set1_f32xN(6.28318531f));
+	f32xN x2 = mul_f32xN(x, x);
+	f32xN p  = set1_f32xN(-1.0f / 39916800.0f);
+	p = add_f32xN(mul_f32xN(p, x2), set1_f32xN( 1.0f / 362880.0f));
+	p = add_f32xN(mul_f32xN(p, x2), set1_f32xN(-1.0f / 5040.0f));
+	p = add_f32xN(mul_f32xN(p, x2), set1_f32xN( 1.0f / 120.0f));
+	p = add_f32xN(mul_f32xN(p, x2), set1_f32xN(-1.0f / 6.0f));
+	p = add_f32xN(mul_f32xN(p, x2), set1_f32xN( 1.0f));
+
+	f32xN result = mul_f32xN(x, p);
+	return result;
+}
+
+function force_inline f32xN
+cos_turns_f32xN(f32xN t)
+{
+	return sin_turns_f32xN(add_f32xN(t, set1_f32xN(0.25f)));
+}
+
+function force_inline f32xN
+linear_from_srgb_f32xN(f32xN c)
+{
+	c = max_f32xN(set1_f32xN(0), min_f32xN(set1_f32xN(1), c));
+	f32xN lo = mul_f32xN(c, set1_f32xN(1.0f / 12.92f));
+	f32xN hi = pow_f32xN(mul_f32xN(add_f32xN(c, set1_f32xN(0.055f)), set1_f32xN(1.0f / 1.055f)), 2.4f);
+	return select_f32xN(greater_f32xN(c, set1_f32xN(0.04045f)), hi, lo);
+}
+
+/* NOTE: also clips out of gamut colours (e.g. from OKLab) back into [0, 1] */
+function force_inline f32xN
+srgb_from_linear_f32xN(f32xN c)
+{
+	c = max_f32xN(set1_f32xN(0), min_f32xN(set1_f32xN(1), c));
+	f32xN lo = mul_f32xN(c, set1_f32xN(12.92f));
+	f32xN hi = sub_f32xN(mul_f32xN(pow_f32xN(c, 1.0f / 2.4f), set1_f32xN(1.055f)), set1_f32xN(0.055f));
+	return select_f32xN(greater_f32xN(c, set1_f32xN(0.0031308f)), hi, lo);
+}
+
+/* NOTE: linear sRGB <-> OKLab (https://bottosson.github.io/posts/oklab/); a and b are
+ * left unscaled here */
+function force_inline void
+oklab_from_linear_lanes(f32xN *x, f32xN *y, f32xN *z)
+{
+	f32xN r = *x, g = *y, b = *z;
+	f32xN l = cbrt_f32xN(dot3_f32xN(r, g, b, 0.4122214708f, 0.5363325363f, 0.0514459929f));
+	f32xN m = cbrt_f32xN(dot3_f32xN(r, g, b, 0.2119034982f, 0.6806995451f, 0.1073969566f));
+	f32xN s = cbrt_f32xN(dot3_f32xN(r, g, b, 0.0883024619f, 0.2817188376f, 0.6299787005f));
+	*x = dot3_f32xN(l, m, s, 0.2104542553f,  0.7936177850f, -0.0040720468f);
+	*y = dot3_f32xN(l, m, s, 1.9779984951f, -2.4285922050f,  0.4505937099f);
+	*z = dot3_f32xN(l, m, s, 0.0259040371f,  0.7827717662f, -0.8086757660f);
+}
+
+function force_inline void
+linear_from_oklab_lanes(f32xN *x, f32xN *y, f32xN *z)
+{
+	f32xN L = *x, a = *y, b = *z;
+	f32xN l = dot3_f32xN(L, a, b, 1,  0.3963377774f,  0.2158037573f);
+	f32xN m = dot3_f32xN(L, a, b, 1, -0.1055613458f, -0.0638541728f);
+	f32xN s = dot3_f32xN(L, a, b, 1, -0.0894841775f, -1.2914855480f);
+	l = mul_f32xN(mul_f32xN(l, l), l);
+	m = mul_f32xN(mul_f32xN(m, m), m);
+	s = mul_f32xN(mul_f32xN(s, s), s);
+	*x = dot3_f32xN(l, m, s,  4.0767416621f, -3.3077115913f,  0.2309699292f);
+	*y = dot3_f32xN(l, m, s, -1.2684380046f,  2.6097574011f, -0.3413193965f);
+	*z = dot3_f32xN(l, m, s, -0.0041960863f, -0.7034186147f,  1.7076147010f);
+}
+
+/* NOTE: the linear_* variants skip the sRGB transfer function so that callers which
+ * already have linear light (e.g. from the sRGB lookup tables) can use them directly */
+function force_inline void
+linear_to_oklab_lanes(f32xN *x, f32xN *y, f32xN *z)
+{
+	oklab_from_linear_lanes(x, y, z);
+	*y = add_f32xN(mul_f32xN(*y, set1_f32xN(1.0f / OKLAB_AB_RANGE)), set1_f32xN(0.5f));
+	*z = add_f32xN(mul_f32xN(*z, set1_f32xN(1.0f / OKLAB_AB_RANGE)), set1_f32xN(0.5f));
+}
+
+function force_inline void
+oklab_to_linear_lanes(f32xN *x, f32xN *y, f32xN *z)
+{
+	*y = mul_f32xN(sub_f32xN(*y, set1_f32xN(0.5f)), set1_f32xN(OKLAB_AB_RANGE));
+	*z = mul_f32xN(sub_f32xN(*z, set1_f32xN(0.5f)), set1_f32xN(OKLAB_AB_RANGE));
+	linear_from_oklab_lanes(x, y, z);
+}
+
+/* NOTE: OKLCH is OKLab in polar form so these never leave OKLab. L passes through. */
+function force_inline void
+oklab_to_oklch_lanes(f32xN *x, f32xN *y, f32xN *z)
+{
+	(void)x;
+	f32xN a = mul_f32xN(sub_f32xN(*y, set1_f32xN(0.5f)), set1_f32xN(OKLAB_AB_RANGE));
+	f32xN b = mul_f32xN(sub_f32xN(*z, set1_f32xN(0.5f)), set1_f32xN(OKLAB_AB_RANGE));
+	f32xN C = sqrt_f32xN(add_f32xN(mul_f32xN(a, a), mul_f32xN(b, b)));
+	*y = mul_f32xN(C, set1_f32xN(1.0f / OKLCH_C_RANGE));
+	*z = atan2_turns_f32xN(b, a);
+}
+
+function force_inline void
+oklch_to_oklab_lanes(f32xN *x, f32xN *y, f32xN *z)
+{
+	(void)x;
+	f32xN C = mul_f32xN(*y, set1_f32xN(OKLCH_C_RANGE / OKLAB_AB_RANGE));
+	f32xN h = *z;
+	*y = add_f32xN(mul_f32xN(C, cos_turns_f32xN(h)), set1_f32xN(0.5f));
+	*z = add_f32xN(mul_f32xN(C, sin_turns_f32xN(h)), set1_f32xN(0.5f));
+}
+
+function force_inline void
+linear_to_oklch_lanes(f32xN *x, f32xN *y, f32xN *z)
+{
+	linear_to_oklab_lanes(x, y, z);
+	oklab_to_oklch_lanes(x, y, z);
+}
+
+function force_inline void
+oklch_to_linear_lanes(f32xN *x, f32xN *y, f32xN *z)
+{
+	oklch_to_oklab_lanes(x, y, z);
+	oklab_to_linear_lanes(x, y, z);
+}
+
+function force_inline void
+rgb_to_oklab_lanes(f32xN *x, f32xN *y, f32xN *z)
+{
+	*x = linear_from_srgb_f32xN(*x);
+	*y = linear_from_srgb_f32xN(*y);
+	*z = linear_from_srgb_f32xN(*z);
+	linear_to_oklab_lanes(x, y, z);
+}
+
+function force_inline void
+oklab_to_rgb_lanes(f32xN *x, f32xN *y, f32xN *z)
+{
+	oklab_to_linear_lanes(x, y, z);
+	*x = srgb_from_linear_f32xN(*x);
+	*y = srgb_from_linear_f32xN(*y);
+	*z = srgb_from_linear_f32xN(*z);
+}
+
+COLOUR_SOA_KERNEL(linear_to_oklab_soa, linear_to_oklab_lanes)
+COLOUR_SOA_KERNEL(oklab_to_linear_soa, oklab_to_linear_lanes)
+COLOUR_SOA_KERNEL(linear_to_oklch_soa, linear_to_oklch_lanes)
+COLOUR_SOA_KERNEL(oklch_to_linear_soa, oklch_to_linear_lanes)
+
+/* NOTE: Conversion graph. Every (from, to) pair gets its own fused kernel which runs
+ * `from -> from hub -> to hub -> to` entirely in registers; nothing is stored in
+ * between. Kinds on the same hub never leave it, so e.g. OKLab <-> OKLCH is a polar
+ * transform and never clips to the sRGB gamut. Only crossing between the rgb and oklab
+ * hubs goes through the sRGB transfer function. Adding a kind only requires its
+ * <name>_to_<hub>_lanes/<hub>_to_<name>_lanes and a list entry. */
+function force_inline void
+rgb_to_rgb_lanes(f32xN *x, f32xN *y, f32xN *z)
+{
+	(void)x; (void)y; (void)z;
+}
+
+function force_inline void
+oklab_to_oklab_lanes(f32xN *x, f32xN *y, f32xN *z)
+{
+	(void)x; (void)y; (void)z;
+}
+
+#define COLOUR_PAIR_KERNEL(from_kind, from, from_hub, to_kind, to, to_hub) \
+function force_inline void \
+from##_to_##to##_fused_lanes(f32xN *x, f32xN *y, f32xN *z) \
+{ \
+	if (ColourKind_##from_kind != ColourKind_##to_kind) { \
+		from##_to_##from_hub##_lanes(x, y, z); \
+		from_hub##_to_##to_hub##_lanes(x, y, z); \
+		to_hub##_to_##to##_lanes(x, y, z); \
+	} \
+} \
+COLOUR_SOA_KERNEL(convert_##from##_to_##to##_soa, from##_to_##to##_fused_lanes)
+
+#define COLOUR_PAIR_KERNELS(_, kind, name, hub) COLOUR_KIND_LIST_INNER(COLOUR_PAIR_KERNEL, kind, name, hub)
+COLOUR_KIND_LIST(COLOUR_PAIR_KERNELS, _)
+#undef COLOUR_PAIR_KERNELS
+#undef COLOUR_PAIR_KERNEL
+
+#define COLOUR_PAIR_ENTRY(from_kind, from, from_hub, to_kind, to, to_hub) \
+	[ColourKind_##to_kind] = convert_##from##_to_##to##_soa,
+#define COLOUR_PAIR_ROW(_, kind, name, hub) \
+	[ColourKind_##kind] = {COLOUR_KIND_LIST_INNER(COLOUR_PAIR_ENTRY, kind, name, hub)},
+global colour_soa_kernel_fn * const colour_conversion_table[ColourKind_Last][ColourKind_Last] = {
+	COLOUR_KIND_LIST(COLOUR_PAIR_ROW, _)
+};
+#undef COLOUR_PAIR_ROW
+#undef COLOUR_PAIR_ENTRY
+
+function void
+convert_colour_soa(f32 *restrict x, f32 *restrict y, f32 *restrict z, s64 count,
+                   ColourKind from, ColourKind to)
+{
+	if (from != to) colour_conversion_table[from][to](x, y, z, count);
+}
+
+/* NOTE: kernels between linear light and the kinds defined on it; 0 for the kinds which
+ * are defined on gamma encoded sRGB. 8 bit sRGB data can pair these with the sRGB lookup
+ * tables instead of evaluating the transfer function. */
+global colour_soa_kernel_fn * const linear_to_colour_table[ColourKind_Last] = {
+	[ColourKind_OKLab] = linear_to_oklab_soa,
+	[ColourKind_OKLCH] = linear_to_oklch_soa,
+};
+global colour_soa_kernel_fn * const colour_to_linear_table[ColourKind_Last] = {
+	[ColourKind_OKLab] = oklab_to_linear_soa,
+	[ColourKind_OKLCH] = oklch_to_linear_soa,
+};
+
+function v4
+convert_colour(v4 colour, ColourKind from, ColourKind to)
+{
+	v4 result = colour;
+	convert_colour_soa(result.E + 0, result.E + 1, result.E + 2, 1, from, to);
+	return result;
+}
+
 function v4
 normalize_colour(u32 rgba)
 {
@@ -353,6 +1001,215 @@ rl_colour_from_normalized(v4 colour)
 	return result;
 }
 
+/* NOTE: Fixed point HSV for packed 8 bit colours. These never touch floating point
+ * values which aren't exact integers.
+ *
+ * HSV16 is packed into a u64 as h[47:32] s[31:16] v[15:8] a[7:0]. Hue is in
+ * turns (65536 == 1 turn), saturation is 65535 == 1 and value is kept at 8 bits
+ * since it is always exactly the max channel. Every RGBA8 colour survives
+ * rgba8 -> hsv16 -> rgba8 exactly.
+ *
+ * HSV8 is packed like RGBA8 as h[31:24] s[23:16] v[15:8] a[7:0]. It is lossy: 256
+ * hue steps cannot resolve the 6 * 255 distinct hues an RGBA8 colour can have.
+ *
+ * The lanes hold a packed colour split into its high (hi) and low (lo) 32 bits; u32
+ * colours only use lo. */
+
+/* NOTE: floor(n / d) for integral 0 <= n < 2^30 and 0 < d < 2^16. The f32 reciprocal
+ * gets within one of the quotient and the integer remainder fixes it up. */
+function force_inline s32xN
+div_exact_s32xN(s32xN n, s32xN d)
+{
+	f32xN fd = f32xN_from_s32xN(d);
+	f32xN fq = mul_f32xN(f32xN_from_s32xN(n), div_f32xN(set1_f32xN(1), fd));
+	s32xN q  = s32xN_from_f32xN(floor_f32xN(fq));
+	s32xN r  = sub_s32xN(n, mul_s32xN(q, d));
+	/* NOTE: r < 0 means q is one too big; r >= d means it is one too small */
+	q = sub_s32xN(q, shr_s32xN(r, 31));
+	q = add_s32xN(q, shr_s32xN(sub_s32xN(sub_s32xN(d, set1_s32xN(1)), r), 31));
+	return q;
+}
+
+function force_inline void
+hsv16_from_rgba8_lanes(s32xN *hi, s32xN *lo)
+{
+	s32xN byte = set1_s32xN(0xFF);
+	f32xN r = f32xN_from_s32xN(and_s32xN(shr_s32xN(*lo, 24), byte));
+	f32xN g = f32xN_from_s32xN(and_s32xN(shr_s32xN(*lo, 16), byte));
+	f32xN b = f32xN_from_s32xN(and_s32xN(shr_s32xN(*lo,  8), byte));
+	s32xN a = and_s32xN(*lo, byte);
+
+	f32xN M = max_f32xN(max_f32xN(r, g), b);
+	f32xN m = min_f32xN(min_f32xN(r, g), b);
+	f32xN C = sub_f32xN(M, m);
+
+	/* NOTE: sector of the hexcone and distance k travelled through it; ties resolve
+	 * the same way as the float conversion. Everything here is a small integer so the
+	 * f32 math is exact. */
+	f32xN max_r = equal_f32xN(M, r), max_g = equal_f32xN(M, g);
+	f32xN min_r = equal_f32xN(m, r), min_b = equal_f32xN(m, b);
+	f32xN sector = select_f32xN(min_r, set1_f32xN(3), set1_f32xN(4));
+	f32xN k      = select_f32xN(min_r, sub_f32xN(M, g), sub_f32xN(r, m));
+	sector = select_f32xN(max_g, select_f32xN(min_b, set1_f32xN(1), set1_f32xN(2)), sector);
+	k      = select_f32xN(max_g, select_f32xN(min_b, sub_f32xN(M, r), sub_f32xN(b, m)), k);
+	sector = select_f32xN(max_r, select_f32xN(min_b, set1_f32xN(0), set1_f32xN(5)), sector);
+	k      = select_f32xN(max_r, select_f32xN(min_b, sub_f32xN(g, m), sub_f32xN(M, b)), k);
+
+	/* NOTE: h = round(65536 * (sector + k / C) / 6), a full turn wraps to 0. C == 0 always
+	 * lands in sector 0 with k == 0 so only the divisor needs guarding */
+	s32xN Ci = s32xN_from_f32xN(C);
+	s32xN Mi = s32xN_from_f32xN(M);
+	s32xN n  = s32xN_from_f32xN(add_f32xN(mul_f32xN(sector, C), k));
+	n = add_s32xN(shl_s32xN(n, 16), mul_s32xN(Ci, set1_s32xN(3)));
+	s32xN d = s32xN_from_f32xN(max_f32xN(mul_f32xN(C, set1_f32xN(6)), set1_f32xN(1)));
+	s32xN h = and_s32xN(div_exact_s32xN(n, d), set1_s32xN(0xFFFF));
+
+	s32xN sn = add_s32xN(mul_s32xN(Ci, set1_s32xN(65535)), shr_s32xN(Mi, 1));
+	s32xN s  = div_exact_s32xN(sn, s32xN_from_f32xN(max_f32xN(M, set1_f32xN(1))));
+
+	*hi = h;
+	*lo = or_s32xN(or_s32xN(shl_s32xN(s, 16), shl_s32xN(Mi, 8)), a);
+}
+
+function force_inline void
+rgba8_from_hsv16_lanes(s32xN *hi, s32xN *lo)
+{
+	s32xN byte = set1_s32xN(0xFF);
+	s32xN h = and_s32xN(*hi, set1_s32xN(0xFFFF));
+	s32xN s = shr_s32xN(*lo, 16);
+	s32xN M = and_s32xN(shr_s32xN(*lo, 8), byte);
+	s32xN a = and_s32xN(*lo, byte);
+
+	s32xN C = div_exact_s32xN(add_s32xN(mul_s32xN(s, M), set1_s32xN(32767)), set1_s32xN(65535));
+	s32xN m = sub_s32xN(M, C);
+
+	s32xN t       = mul_s32xN(h, set1_s32xN(6));
+	s32xN k       = mul_s32xN(and_s32xN(t, set1_s32xN(0xFFFF)), C);
+	k             = shr_s32xN(add_s32xN(k, set1_s32xN(32768)), 16);
+	s32xN rising  = add_s32xN(m, k);
+	s32xN falling = sub_s32xN(M, k);
+
+	/* NOTE: pick the channels for each sector; the selects only move bits around so
+	 * they can work on the integer lanes directly */
+	f32xN sector = f32xN_from_s32xN(shr_s32xN(t, 16));
+	#define SECTOR_RGB(n, R, G, B) do { \
+		f32xN is = equal_f32xN(sector, set1_f32xN(n)); \
+		fr = select_f32xN(is, bits_f32xN(R), fr); \
+		fg = select_f32xN(is, bits_f32xN(G), fg); \
+		fb = select_f32xN(is, bits_f32xN(B), fb); \
+	} while (0)
+	f32xN fr = bits_f32xN(M), fg = bits_f32xN(m), fb = bits_f32xN(falling);
+	SECTOR_RGB(0, M,       rising,  m);
+	SECTOR_RGB(1, falling, M,       m);
+	SECTOR_RGB(2, m,       M,       rising);
+	SECTOR_RGB(3, m,       falling, M);
+	SECTOR_RGB(4, rising,  m,       M);
+	#undef SECTOR_RGB
+
+	*hi = set1_s32xN(0);
+	*lo = or_s32xN(or_s32xN(shl_s32xN(bits_s32xN(fr), 24), shl_s32xN(bits_s32xN(fg), 16)),
+	               or_s32xN(shl_s32xN(bits_s32xN(fb), 8), a));
+}
+
+function force_inline void
+hsv8_from_rgba8_lanes(s32xN *hi, s32xN *lo)
+{
+	hsv16_from_rgba8_lanes(hi, lo);
+	s32xN h = and_s32xN(shr_s32xN(add_s32xN(*hi, set1_s32xN(0x80)), 8), set1_s32xN(0xFF));
+	s32xN s = mul_s32xN(shr_s32xN(*lo, 16), set1_s32xN(255));
+	s = div_exact_s32xN(add_s32xN(s, set1_s32xN(32767)), set1_s32xN(65535));
+	*hi = set1_s32xN(0);
+	*lo = or_s32xN(or_s32xN(shl_s32xN(h, 24), shl_s32xN(s, 16)), and_s32xN(*lo, set1_s32xN(0xFFFF)));
+}
+
+function force_inline void
+rgba8_from_hsv8_lanes(s32xN *hi, s32xN *lo)
+{
+	s32xN s = mul_s32xN(and_s32xN(shr_s32xN(*lo, 16), set1_s32xN(0xFF)), set1_s32xN(257));
+	*hi = shl_s32xN(shr_s32xN(*lo, 24), 8);
+	*lo = or_s32xN(shl_s32xN(s, 16), and_s32xN(*lo, set1_s32xN(0xFFFF)));
+	rgba8_from_hsv16_lanes(hi, lo);
+}
+
+/* NOTE: runs `lanes_fn` over packed colours F32_LANES at a time. The words are split out
+ * with scalar code since there is no portable u64 lane deinterleave; the tail is padded
+ * like COLOUR_SOA_KERNEL's */
+#define PACKED_COLOUR_KERNEL(name, out_type, in_type, lanes_fn) \
+function void \
+name(out_type *restrict out, in_type *restrict in, s64 count) \
+{ \
+	for (s64 i = 0; i < count; i += F32_LANES) { \
+		alignas(32) u32 hi[F32_LANES] = {0}, lo[F32_LANES] = {0}; \
+		s64 n = Min(count - i, F32_LANES); \
+		for (s64 j = 0; j < n; j++) { \
+			hi[j] = (u32)((u64)in[i + j] >> 32); \
+			lo[j] = (u32)in[i + j]; \
+		} \
+		s32xN h = load_s32xN(hi), l = load_s32xN(lo); \
+		lanes_fn(&h, &l); \
+		store_s32xN(hi, h); store_s32xN(lo, l); \
+		for (s64 j = 0; j < n; j++) \
+			out[i + j] = (out_type)((u64)hi[j] << 32 | lo[j]); \
+	} \
+}
+
+PACKED_COLOUR_KERNEL(hsv16_from_rgba8_buffer, u64, u32, hsv16_from_rgba8_lanes)
+PACKED_COLOUR_KERNEL(rgba8_from_hsv16_buffer, u32, u64, rgba8_from_hsv16_lanes)
+PACKED_COLOUR_KERNEL(hsv8_from_rgba8_buffer,  u32, u32, hsv8_from_rgba8_lanes)
+PACKED_COLOUR_KERNEL(rgba8_from_hsv8_buffer,  u32, u32, rgba8_from_hsv8_lanes)
+
+/* NOTE: 8 bit sRGB <-> linear light through the tables generated by gen_incs. The
+ * transfer function is never evaluated at runtime; alpha is not gamma encoded. */
+function void
+linear_from_srgb8_soa(f32 *restrict x, f32 *restrict y, f32 *restrict z, s64 count)
+{
+	/* NOTE: the channels hold c / 255 for 8 bit c so the rounding recovers c exactly */
+	for (s64 i = 0; i < count; i++) {
+		x[i] = srgb_to_linear_lut[(u32)(x[i] * 255 + 0.5f)];
+		y[i] = srgb_to_linear_lut[(u32)(y[i] * 255 + 0.5f)];
+		z[i] = srgb_to_linear_lut[(u32)(z[i] * 255 + 0.5f)];
+	}
+}
+
+function u32
+linear_to_srgb8(f32 c)
+{
+	c = Clamp01(c);
+	u32 result = linear_to_srgb_lut[(u32)(c * (LINEAR_TO_SRGB_LUT_SIZE - 1) + 0.5f)];
+	return result;
+}
+
+/* NOTE: runs a linear light SoA kernel over packed RGBA8 input in chunks small enough
+ * to stay in L1 */
+#define RGBA8_SOA_CHUNK 256
+function void
+rgba8_to_colour_buffer(v4 *restrict out, u32 *restrict in, s64 count, colour_soa_kernel_fn *kernel)
+{
+	alignas(64) f32 x[RGBA8_SOA_CHUNK], y[RGBA8_SOA_CHUNK], z[RGBA8_SOA_CHUNK];
+	for (s64 base = 0; base < count; base += RGBA8_SOA_CHUNK) {
+		s64 n = Min(count - base, RGBA8_SOA_CHUNK);
+		for (s64 i = 0; i < n; i++) {
+			u32 rgba = in[base + i];
+			x[i] = srgb_to_linear_lut[(rgba >> 24) & 0xFF];
+			y[i] = srgb_to_linear_lut[(rgba >> 16) & 0xFF];
+			z[i] = srgb_to_linear_lut[(rgba >>  8) & 0xFF];
+		}
+		if (kernel) kernel(x, y, z, n);
+		for (s64 i = 0; i < n; i++) {
+			out[base + i].x = x[i];
+			out[base + i].y = y[i];
+			out[base + i].z = z[i];
+			out[base + i].w = (in[base + i] & 0xFF) / 255.0f;
+		}
+	}
+}
+
+function void
+oklab_from_rgba8_buffer(v4 *restrict out, u32 *restrict in, s64 count)
+{
+	rgba8_to_colour_buffer(out, in, count, linear_to_oklab_soa);
+}
+
 function v2
 add_v2(v2 a, v2 b)
 {
@@ -362,6 +1219,42 @@ add_v2(v2 a, v2 b)
 	return result;
 }
 
+/* NOTE: SWAR hex parse of up to 8 ASCII digits packed little endian into `word`. Returns
+ * the value of the leading run of hex digits and stores its length in `digits`. */
+function u32
+hex_u32_from_swar(u64 word, s64 *digits)
+{
+	#define SWAR_BYTES(b) (0x0101010101010101ull * (u8)(b))
+	/* NOTE: byte wise x in [lo, hi]; only valid for bytes below 0x80 */
+	#define SWAR_IN_RANGE(x, lo, hi) \
+		(((x) + SWAR_BYTES(0x80 - (lo))) & ~((x) + SWAR_BYTES(0x7F - (hi))) & SWAR_BYTES(0x80))
+
+	u64 ascii   = ~word & SWAR_BYTES(0x80);
+	u64 low     = word & SWAR_BYTES(0x7F);
+	u64 digit   = SWAR_IN_RANGE(low, '0', '9');
+	u64 letter  = SWAR_IN_RANGE(low | SWAR_BYTES(0x20), 'a', 'f');
+	u64 invalid = ~(digit | letter) & ascii;
+	invalid    |= ~ascii & SWAR_BYTES(0x80);
+
+	s64 count = (s64)ctz_u64(invalid) / 8;
+	*digits   = count;
+
+	/* NOTE: '0'-'9' -> 0-9, 'a'-'f'/'A'-'F' -> 10-15; bytes past the run are zeroed */
+	u64 nibbles = (word & SWAR_BYTES(0x0F)) + 9 * ((word >> 6) & SWAR_BYTES(0x01));
+	if (count < 8) nibbles &= (1ull << (8 * count)) - 1;
+
+	/* NOTE: the first digit is in the lowest byte; merge pairs, then bytes, then halves */
+	nibbles = ((nibbles & 0x000F000F000F000Full) << 4) | ((nibbles & 0x0F000F000F000F00ull) >> 8);
+	nibbles = ((nibbles & 0x000000FF000000FFull) << 8) | ((nibbles & 0x00FF000000FF0000ull) >> 16);
+	nibbles = ((nibbles & 0x000000000000FFFFull) << 16) | ((nibbles & 0x0000FFFF00000000ull) >> 32);
+
+	u32 result = count ? (u32)(nibbles >> (4 * (8 - count))) : 0;
+
+	#undef SWAR_IN_RANGE
+	#undef SWAR_BYTES
+	return result;
+}
+
 function NumberConversion
 integer_from_str8(str8 raw, b32 hex)
 {
@@ -381,11 +1274,21 @@ integer_from_str8(str8 raw, b32 hex)
 		i     =  1;
 	}
 
-	if (raw.length - i > 2 && raw.data[i] == '0' && (raw.data[1] == 'x' || raw.data[1] == 'X')) {
+	if (raw.length - i > 2 && raw.data[i] == '0' && (raw.data[i + 1] == 'x' || raw.data[i + 1] == 'X')) {
 		hex = 1;
 		i += 2;
 	}
 
+	/* NOTE: fast path; colours are almost always 6 or 8 hex digits which fit in a single
+	 * word. Anything past the first 8 digits continues through the general loop. */
+	if (hex && i < raw.length) {
+		u64 word = 0;
+		memory_copy(&word, raw.data + i, Min(raw.length - i, (s64)sizeof(word)));
+		s64 digits;
+		result.U64 = hex_u32_from_swar(word, &digits);
+		i += digits;
+	}
+
 	#define integer_conversion_body(radix, clamp) do {\
 		for (; i < raw.length; i++) {\
 			s64 value = lut[Min((u8)(raw.data[i] - (u8)'0'), clamp)];\
@@ -416,42 +1319,527 @@ integer_from_str8(str8 raw, b32 hex)
 	return result;
 }
 
+/* NOTE: Simple decimal conversion (based on Go's strconv). Only reached for inputs which
+ * are very long, subnormal, out of range or sit exactly on a rounding boundary. */
+function void
+decimal_trim(Decimal *d)
+{
+	while (d->count > 0 && d->digits[d->count - 1] == 0) d->count--;
+	if (d->count == 0) d->point = 0;
+}
+
+function void
+decimal_right_shift(Decimal *d, u32 k)
+{
+	s32 r = 0, w = 0;
+	u64 n = 0;
+	for (; (n >> k) == 0; r++) {
+		if (r >= d->count) {
+			if (n == 0) {
+				d->count = 0;
+				return;
+			}
+			while ((n >> k) == 0) { n *= 10; r++; }
+			break;
+		}
+		n = n * 10 + d->digits[r];
+	}
+	d->point -= r - 1;
+
+	u64 mask = (1ull << k) - 1;
+	for (; r < d->count; r++) {
+		u64 digit = d->digits[r];
+		d->digits[w++] = (u8)(n >> k);
+		n = (n & mask) * 10 + digit;
+	}
+	while (n > 0) {
+		u64 digit = n >> k;
+		n &= mask;
+		if (w < DECIMAL_MAX_DIGITS) d->digits[w++] = (u8)digit;
+		else if (digit > 0)         d->truncated = 1;
+		n *= 10;
+	}
+	d->count = w;
+	decimal_trim(d);
+}
+
+function void
+decimal_left_shift(Decimal *d, u32 k)
+{
+	/* NOTE: k <= 60 so at most 19 new digits appear */
+	u8  scratch[DECIMAL_MAX_DIGITS + 20];
+	s32 w = countof(scratch);
+	u64 n = 0;
+	for (s32 r = d->count - 1; r >= 0; r--) {
+		n += (u64)d->digits[r] << k;
+		u64 quotient = n / 10;
+		scratch[--w] = (u8)(n - 10 * quotient);
+		n = quotient;
+	}
+	while (n > 0) {
+		u64 quotient = n / 10;
+		scratch[--w] = (u8)(n - 10 * quotient);
+		n = quotient;
+	}
+
+	s32 count = (s32)countof(scratch) - w;
+	d->point += count - d->count;
+	if (count > DECIMAL_MAX_DIGITS) {
+		for (s32 i = DECIMAL_MAX_DIGITS; i < count; i++)
+			d->truncated |= scratch[w + i] != 0;
+		count = DECIMAL_MAX_DIGITS;
+	}
+	memory_copy(d->digits, scratch + w, count);
+	d->count = count;
+	decimal_trim(d);
+}
+
+function void
+decimal_shift(Decimal *d, s32 k)
+{
+	#define DECIMAL_MAX_SHIFT 60
+	if (d->count > 0) {
+		for (; k >  DECIMAL_MAX_SHIFT; k -= DECIMAL_MAX_SHIFT) decimal_left_shift(d, DECIMAL_MAX_SHIFT);
+		for (; k < -DECIMAL_MAX_SHIFT; k += DECIMAL_MAX_SHIFT) decimal_right_shift(d, DECIMAL_MAX_SHIFT);
+		if (k > 0) decimal_left_shift(d, (u32)k);
+		if (k < 0) decimal_right_shift(d, (u32)-k);
+	}
+	#undef DECIMAL_MAX_SHIFT
+}
+
+function b32
+decimal_should_round_up(Decimal *d, s32 n)
+{
+	b32 result = 0;
+	if (n >= 0 && n < d->count) {
+		if (d->digits[n] == 5 && n + 1 == d->count) {
+			/* NOTE: exactly halfway; round to even unless digits were dropped */
+			result = d->truncated || (n > 0 && (d->digits[n - 1] % 2) == 1);
+		} else {
+			result = d->digits[n] >= 5;
+		}
+	}
+	return result;
+}
+
+function u64
+decimal_rounded_integer(Decimal *d)
+{
+	u64 result = U64_MAX;
+	if (d->point <= 20) {
+		s32 i  = 0;
+		result = 0;
+		for (; i < d->point && i < d->count; i++) result = result * 10 + d->digits[i];
+		for (; i < d->point; i++)                 result *= 10;
+		if (decimal_should_round_up(d, d->point)) result++;
+	}
+	return result;
+}
+
+/* NOTE: keep n digits rounding half to even */
+function void
+decimal_round(Decimal *d, s32 n)
+{
+	if (n >= 0 && n < d->count) {
+		if (decimal_should_round_up(d, n)) {
+			s32 i = n - 1;
+			for (; i >= 0 && d->digits[i] == 9; i--);
+			if (i < 0) {
+				d->digits[0] = 1;
+				d->count     = 1;
+				d->point++;
+			} else {
+				d->digits[i]++;
+				d->count = i + 1;
+			}
+		} else {
+			d->count = n;
+			decimal_trim(d);
+		}
+	}
+}
+
+/* NOTE: returns the bits of the (unsigned) f64 closest to d */
+function u64
+f64_bits_from_decimal(Decimal *d, b32 *overflow)
+{
+	read_only local_persist u8 power_steps[] = {1, 3, 6, 9, 13, 16, 19, 23, 26};
+	s32 bias = -1023, exponent = 0;
+	u64 mantissa = 0;
+
+	*overflow = 0;
+	if (d->count == 0 || d->point < -330) {
+		exponent = bias;
+	} else if (d->point > 310) {
+		*overflow = 1;
+	} else {
+		/* NOTE: scale by powers of two until d is in [0.5, 1) */
+		while (d->point > 0) {
+			s32 n = d->point < (s32)countof(power_steps) ? power_steps[d->point] : 27;
+			decimal_shift(d, -n);
+			exponent += n;
+		}
+		while (d->point < 0 || (d->point == 0 && d->digits[0] < 5)) {
+			s32 n = -d->point < (s32)countof(power_steps) ? power_steps[-d->point] : 27;
+			decimal_shift(d, n);
+			exponent -= n;
+		}
+		/* NOTE: [0.5, 1) -> [1, 2) */
+		exponent--;
+
+		/* NOTE: subnormals; move the exponent up to the minimum */
+		if (exponent < bias + 1) {
+			s32 n = bias + 1 - exponent;
+			decimal_shift(d, -n);
+			exponent += n;
+		}
+
+		if (exponent - bias >= 0x7FF) {
+			*overflow = 1;
+		} else {
+			decimal_shift(d, 53);
+			mantissa = decimal_rounded_integer(d);
+			if (mantissa == (2ull << 52)) {
+				mantissa >>= 1;
+				exponent++;
+				*overflow = exponent - bias >= 0x7FF;
+			}
+			if ((mantissa & (1ull << 52)) == 0) exponent = bias;
+		}
+	}
+
+	u64 result;
+	if (*overflow) result = 0x7FFull << 52;
+	else           result = (mantissa & ((1ull << 52) - 1)) | (u64)((exponent - bias) & 0x7FF) << 52;
+	return result;
+}
+
+/* NOTE: Eisel-Lemire; computes w * 10^q from the truncated 128 bit power of 10 table.
+ * Returns 0 when the truncation makes the rounding ambiguous, for subnormals and for
+ * overflow; the caller then falls back to the slow path. */
+function b32
+eisel_lemire_f64_bits(u64 w, s64 q, u64 *bits)
+{
+	b32 result = 0;
+	if (w == 0) {
+		*bits  = 0;
+		result = 1;
+	} else if (Between(q, POW10_U128_MIN_EXPONENT, POW10_U128_MAX_EXPONENT)) {
+		u64 lz = clz_u64(w);
+		w    <<= lz;
+
+		/* NOTE: floor(log2(10) * q) + 64 + bias */
+		u64 exponent = (u64)(((217706 * q) >> 16) + 64 + 1023) - lz;
+
+		u128 power = pow10_u128_table[q - POW10_U128_MIN_EXPONENT];
+		u128 x     = mul_u64(w, power.hi);
+		b32  exact = 1;
+		if ((x.hi & 0x1FF) == 0x1FF && x.lo + w < w) {
+			u128 y = mul_u64(w, power.lo);
+			u64 hi = x.hi, lo = x.lo + y.hi;
+			if (lo < x.lo) hi++;
+			exact = !((hi & 0x1FF) == 0x1FF && lo + 1 == 0 && y.lo + w < w);
+			x.hi = hi;
+			x.lo = lo;
+		}
+
+		u64 msb      = x.hi >> 63;
+		u64 mantissa = x.hi >> (msb + 9);
+		exponent    -= 1 ^ msb;
+
+		/* NOTE: halfway ambiguity */
+		if (x.lo == 0 && (x.hi & 0x1FF) == 0 && (mantissa & 3) == 1)
+			exact = 0;
+
+		mantissa += mantissa & 1;
+		mantissa >>= 1;
+		if (mantissa >> 53) {
+			mantissa >>= 1;
+			exponent++;
+		}
+
+		/* NOTE: 0 (subnormal) or >= 0x7FF (inf) */
+		if (exponent - 1 >= 0x7FF - 1)
+			exact = 0;
+
+		if (exact) {
+			*bits  = exponent << 52 | (mantissa & ((1ull << 52) - 1));
+			result = 1;
+		}
+	}
+	return result;
+}
+
 function NumberConversion
 number_from_str8(str8 s)
 {
-	NumberConversion result  = {.unparsed = s};
-	NumberConversion integer = integer_from_str8(s, 0);
-	if (integer.result == NumberConversionResult_Success) {
-		if (integer.unparsed.length != 0 && integer.unparsed.data[0] == '.') {
-			s = integer.unparsed;
-			s.data++;
-			s.length--;
+	read_only local_persist f64 exact_powers_of_ten[] = {
+		1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+	};
 
-			while (s.length > 0 && s.data[s.length - 1] == '0') s.length--;
+	NumberConversion result = {.unparsed = s};
+
+	s64 i = 0;
+	b32 negative = s.length > 0 && s.data[0] == '-';
+	i += negative;
+
+	/* NOTE: up to 19 significant digits are accumulated in w, the rest only move the
+	 * decimal point (and are picked up again by the slow path) */
+	u64 w = 0;
+	s64 w_digits = 0, digits = 0, point = 0, start = i;
+	b32 saw_point = 0, saw_digits = 0, truncated = 0;
+	for (; i < s.length; i++) {
+		u8 c = s.data[i];
+		/* NOTE: consume runs of 8 digits at once (little endian SWAR) */
+		if (digits > 0 && w_digits + 8 <= 19 && s.length - i >= 8) {
+			u64 word;
+			memory_copy(&word, s.data + i, sizeof(word));
+			u64 check = (word & 0xF0F0F0F0F0F0F0F0ull) |
+			            (((word + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4);
+			if (check == 0x3333333333333333ull) {
+				word = ((word & 0x0F0F0F0F0F0F0F0Full) * 2561) >> 8;
+				word = ((word & 0x00FF00FF00FF00FFull) * 6553601) >> 16;
+				word = ((word & 0x0000FFFF0000FFFFull) * 42949672960001ull) >> 32;
+				w         = w * 100000000 + (u32)word;
+				w_digits += 8;
+				digits   += 8;
+				i        += 7;
+				saw_digits = 1;
+				continue;
+			}
+		}
 
-			NumberConversion fractional = integer_from_str8(s, 0);
-			if (fractional.result == NumberConversionResult_Success || s.length == 0) {
-				result.F64 = (f64)fractional.U64;
+		if (c == '.' && !saw_point) {
+			saw_point = 1;
+			point     = digits;
+		} else if (IsDigit(c)) {
+			saw_digits = 1;
+			if (c == '0' && digits == 0) {
+				point--;
+				continue;
+			}
+			digits++;
+			if (w_digits < 19) { w = w * 10 + (u64)(c - '0'); w_digits++; }
+			else if (c != '0') { truncated = 1; }
+		} else {
+			break;
+		}
+	}
+	s64 end = i;
+
+	b32 has_exponent = i + 1 < s.length && (s.data[i] == 'e' || s.data[i] == 'E');
+	/* NOTE: integers (including hex) keep their exact integer value */
+	if (!saw_point && !has_exponent) return integer_from_str8(s, 0);
+
+	if (!saw_point) point = digits;
+
+	if (saw_digits) {
+		if (has_exponent) {
+			s64 j = i + 1, sign = 1, exponent = 0;
+			if (s.data[j] == '+' || s.data[j] == '-') sign = s.data[j++] == '-' ? -1 : 1;
+			if (j < s.length && IsDigit(s.data[j])) {
+				for (; j < s.length && IsDigit(s.data[j]); j++)
+					if (exponent < 10000) exponent = exponent * 10 + (s.data[j] - '0');
+				point += sign * exponent;
+				i = j;
+			}
+		}
 
-				u64 divisor = (u64)(fractional.unparsed.data - s.data);
-				while (divisor > 0) { result.F64 /= 10.0; divisor--; }
+		s64 q = point - w_digits;
+		u64 bits;
+		b32 done = 0, overflow = 0;
+		if (!truncated && w < (1ull << 53)) {
+			/* NOTE: Clinger's fast path; w and 10^|q| are both exact f64s so a single
+			 * correctly rounded operation gives the answer */
+			f64 f = (f64)w;
+			if (Between(q, -22, 0)) {
+				f   /= exact_powers_of_ten[-q];
+				done = 1;
+			} else if (Between(q, 1, 22 + 15)) {
+				/* NOTE: some of the exponent can be moved into w while it stays exact */
+				if (q > 22) { f *= exact_powers_of_ten[q - 22]; q = 22; }
+				if (f <= 1e15) {
+					f   *= exact_powers_of_ten[q];
+					done = 1;
+				}
+			}
+			memory_copy(&bits, &f, sizeof(bits));
+			q = point - w_digits;
+		}
 
-				result.F64 += (f64)integer.S64;
+		if (!done && eisel_lemire_f64_bits(w, q, &bits)) {
+			/* NOTE: with dropped digits the true value lies in [w, w + 1) * 10^q */
+			u64 upper;
+			done = !truncated || (eisel_lemire_f64_bits(w + 1, q, &upper) && upper == bits);
+		}
 
-				result.result   = NumberConversionResult_Success;
-				result.kind     = NumberConversionKind_Float;
-				result.unparsed = fractional.unparsed;
+		if (!done) {
+			Decimal decimal = {0};
+			for (s64 j = start; j < end; j++) {
+				u8 c = s.data[j];
+				if (c == '.' || (c == '0' && decimal.count == 0)) continue;
+				if (decimal.count < DECIMAL_MAX_DIGITS) decimal.digits[decimal.count++] = c - '0';
+				else if (c != '0')                      decimal.truncated = 1;
 			}
-		} else {
-			result = integer;
+			decimal.point = (s32)Clamp(point, -100000, 100000);
+			decimal_trim(&decimal);
+			bits = f64_bits_from_decimal(&decimal, &overflow);
 		}
+
+		if (negative) bits |= 1ull << 63;
+
+		memory_copy(&result.F64, &bits, sizeof(bits));
+		result.result   = overflow ? NumberConversionResult_OutOfRange : NumberConversionResult_Success;
+		result.kind     = NumberConversionKind_Float;
+		result.unparsed = (str8){.length = s.length - i, .data = s.data + i};
 	}
+
 	return result;
 }
 
+read_only global u8 decimal_digit_pairs[200] =
+	"0001020304050607080910111213141516171819"
+	"2021222324252627282930313233343536373839"
+	"4041424344454647484950515253545556575859"
+	"6061626364656667686970717273747576777879"
+	"8081828384858687888990919293949596979899";
+
+/* NOTE: writes n in decimal ending at `end`, two digits per step; returns the start */
+function u8 *
+write_u64_backwards(u8 *end, u64 n)
+{
+	u8 *beg = end;
+	while (n >= 100) {
+		u64 pair = (n % 100) * 2;
+		n /= 100;
+		*--beg = decimal_digit_pairs[pair + 1];
+		*--beg = decimal_digit_pairs[pair + 0];
+	}
+	if (n >= 10) {
+		*--beg = decimal_digit_pairs[2 * n + 1];
+		*--beg = decimal_digit_pairs[2 * n + 0];
+	} else {
+		*--beg = (u8)('0' + n);
+	}
+	return beg;
+}
+
+function s64
+os_write(s32 fd, void *data, s64 size)
+{
+	#if OS_WINDOWS
+	s64 result = _write(fd, data, (u32)Min(size, S32_MAX));
+	#else
+	s64 result = write(fd, data, (u64)size);
+	#endif
+	return result;
+}
+
+/* NOTE: seconds on a monotonic clock; only meaningful as the difference of two calls */
+function f64
+os_get_time(void)
+{
+	#if OS_WINDOWS
+	local_persist u64 frequency;
+	if (!frequency) QueryPerformanceFrequency(&frequency);
+	u64 counter;
+	QueryPerformanceCounter(&counter);
+	f64 result = (f64)counter / (f64)frequency;
+	#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	f64 result = (f64)ts.tv_sec + (f64)ts.tv_nsec * 1e-9;
+	#endif
+	return result;
+}
+
+/* NOTE: attributes the time since the previous mark to phase */
+function void
+startup_profile_mark(StartupProfile *p, StartupPhase phase)
+{
+	f64 now = os_get_time();
+	p->seconds[phase] += now - p->last_mark;
+	p->last_mark       = now;
+}
+
+/* NOTE: writes everything buffered in s to s->fd and empties the buffer */
+function void
+stream_flush(Stream *s)
+{
+	for (u32 written = 0; !s->errors && written < s->widx;) {
+		s64 wrote = os_write(s->fd, s->data + written, s->widx - written);
+		if (wrote > 0) written += (u32)wrote;
+		else           s->errors = 1;
+	}
+	s->widx = 0;
+}
+
+/* NOTE: flushes the buffer and data (which is too large to ever be buffered) with a
+ * single gathered write instead of copying data through the buffer */
+function void
+stream_write_through(Stream *s, void *data, s64 count)
+{
+	#if OS_WINDOWS
+	stream_flush(s);
+	for (s64 written = 0; !s->errors && written < count;) {
+		s64 wrote = os_write(s->fd, (u8 *)data + written, count - written);
+		if (wrote > 0) written += wrote;
+		else           s->errors = 1;
+	}
+	#else
+	struct iovec iov[2] = {
+		{.iov_base = s->data, .iov_len = s->widx},
+		{.iov_base = data,    .iov_len = (u64)count},
+	};
+	s32 first = s->widx == 0;
+	while (!s->errors && first < (s32)countof(iov)) {
+		s64 wrote = writev(s->fd, iov + first, (s32)countof(iov) - first);
+		if (wrote <= 0) {
+			s->errors = 1;
+		} else {
+			for (; first < (s32)countof(iov) && (u64)wrote >= iov[first].iov_len; first++)
+				wrote -= (s64)iov[first].iov_len;
+			if (first < (s32)countof(iov)) {
+				iov[first].iov_base  = (u8 *)iov[first].iov_base + wrote;
+				iov[first].iov_len  -= (u64)wrote;
+			}
+		}
+	}
+	#endif
+	s->widx = 0;
+}
+
+/* NOTE: makes room for count more bytes in a growable stream; sets errors if it can't */
+function void
+stream_grow(Stream *s, s64 count)
+{
+	u64 needed = (u64)s->widx + (u64)count;
+	u64 cap    = Min(Max(2 * (u64)s->cap, needed), U32_MAX);
+	u8 *data   = needed <= U32_MAX ? realloc(s->data, cap) : 0;
+	if (data) {
+		s->data = data;
+		s->cap  = (u32)cap;
+	} else {
+		s->errors = 1;
+	}
+}
+
 function void
 stream_append(Stream *s, void *data, s64 count)
 {
+	if (unlikely((s->cap - s->widx) < count) && s->fd != 0 && !s->errors) {
+		if (s->fd == STREAM_GROWABLE) {
+			stream_grow(s, count);
+		} else {
+			if (count >= s->cap) {
+				stream_write_through(s, data, count);
+				return;
+			}
+			stream_flush(s);
+		}
+	}
+
 	s->errors |= (s->cap - s->widx) < count;
 	if (!s->errors) {
 		memory_copy(s->data + s->widx, data, count);
@@ -465,28 +1853,28 @@ stream_append_byte(Stream *s, u8 b)
 	stream_append(s, &b, 1);
 }
 
-function void
-stream_append_hex_u64_width(Stream *s, u64 n, s64 width)
+/* NOTE: SWAR u32 -> 8 lowercase hex characters (most significant first) */
+function u64
+hex_chars_from_u32(u32 n)
 {
-	assert(width <= 16);
-	if (!s->errors) {
-		u8  buf[16];
-		u8 *end = buf + sizeof(buf);
-		u8 *beg = end;
-		while (n) {
-			*--beg = (u8)"0123456789abcdef"[n & 0x0F];
-			n >>= 4;
-		}
-		while (end - beg < width)
-			*--beg = '0';
-		stream_append(s, beg, end - beg);
-	}
+	/* NOTE: byte swap so the most significant byte lands at the lowest address, then
+	 * spread each byte into a 16 bit lane and split it into its two nibbles */
+	u64 x = byte_swap_u32(n);
+	x = (x | (x << 16)) & 0x0000FFFF0000FFFFull;
+	x = (x | (x <<  8)) & 0x00FF00FF00FF00FFull;
+	x = ((x >> 4) & 0x000F000F000F000Full) | ((x & 0x000F000F000F000Full) << 8);
+
+	/* NOTE: '0' + x, plus ('a' - '0' - 10) for the nibbles above 9 */
+	u64 letters = ((x + 0x0606060606060606ull) >> 4) & 0x0101010101010101ull;
+	u64 result  = x + 0x3030303030303030ull + letters * ('a' - '0' - 10);
+	return result;
 }
 
 function void
-stream_append_hex_u64(Stream *s, u64 n)
+stream_append_hex_u32(Stream *s, u32 n)
 {
-	stream_append_hex_u64_width(s, n, 2);
+	u64 chars = hex_chars_from_u32(n);
+	stream_append(s, &chars, sizeof(chars));
 }
 
 function void
@@ -500,10 +1888,9 @@ stream_append_u64_width(Stream *s, u64 n, s64 width)
 {
 	u8 tmp[64];
 	u8 *end = tmp + countof(tmp);
-	u8 *beg = end;
+	u8 *beg = write_u64_backwards(end, n);
 	width = Min((s64)countof(tmp), width);
 
-	do { *--beg = (u8)('0' + (n % 10)); } while (n /= 10);
 	while (end - beg > 0 && (end - beg) < width)
 		*--beg = '0';
 
@@ -516,39 +1903,298 @@ stream_append_u64(Stream *s, u64 n)
 	stream_append_u64_width(s, n, 0);
 }
 
+/* NOTE: Ryu (Ulf Adams, 2018) shortest decimal representation of an f32; produces the
+ * fewest digits m such that m * 10^e parses back to exactly `bits` */
+function force_inline u32
+ryu_pow5_bits(s32 e)
+{
+	return (((u32)e * 1217359) >> 19) + 1;
+}
+
+function force_inline u32
+ryu_mul_shift_u32(u32 m, u64 factor, s32 shift)
+{
+	u64 lo = (u64)m * (u32)factor;
+	u64 hi = (u64)m * (u32)(factor >> 32);
+	u32 result = (u32)(((lo >> 32) + hi) >> (shift - 32));
+	return result;
+}
+
+function force_inline b32
+ryu_multiple_of_power_of_5(u32 value, u32 p)
+{
+	u32 count = 0;
+	for (; value % 5 == 0; value /= 5) count++;
+	return count >= p;
+}
+
+function void
+ryu_f32_decimal(u32 bits, u32 *mantissa, s32 *exponent)
+{
+	u32 ieee_mantissa = bits & ((1u << 23) - 1);
+	u32 ieee_exponent = (bits >> 23) & 0xFF;
+
+	s32 e2;
+	u32 m2;
+	if (ieee_exponent == 0) {
+		e2 = 1 - 127 - 23 - 2;
+		m2 = ieee_mantissa;
+	} else {
+		e2 = (s32)ieee_exponent - 127 - 23 - 2;
+		m2 = (1u << 23) | ieee_mantissa;
+	}
+	b32 accept_bounds = (m2 & 1) == 0;
+
+	/* NOTE: the interval of values which round to this float, scaled by 4 */
+	u32 mv       = 4 * m2;
+	u32 mp       = 4 * m2 + 2;
+	u32 mm_shift = ieee_mantissa != 0 || ieee_exponent <= 1;
+	u32 mm       = 4 * m2 - 1 - mm_shift;
+
+	u32 vr, vp, vm;
+	s32 e10;
+	b32 vm_trailing_zeros = 0, vr_trailing_zeros = 0;
+	u32 last_removed_digit = 0;
+	if (e2 >= 0) {
+		u32 q = ((u32)e2 * 78913) >> 18;
+		s32 k = RYU_F32_POW5_INV_BITCOUNT + (s32)ryu_pow5_bits((s32)q) - 1;
+		s32 i = -e2 + (s32)q + k;
+		e10 = (s32)q;
+		vr  = ryu_mul_shift_u32(mv, ryu_f32_pow5_inv_split[q], i);
+		vp  = ryu_mul_shift_u32(mp, ryu_f32_pow5_inv_split[q], i);
+		vm  = ryu_mul_shift_u32(mm, ryu_f32_pow5_inv_split[q], i);
+		if (q != 0 && (vp - 1) / 10 <= vm / 10) {
+			s32 l = RYU_F32_POW5_INV_BITCOUNT + (s32)ryu_pow5_bits((s32)q - 1) - 1;
+			last_removed_digit = ryu_mul_shift_u32(mv, ryu_f32_pow5_inv_split[q - 1],
+			                                       -e2 + (s32)q - 1 + l) % 10;
+		}
+		if (q <= 9) {
+			/* NOTE: at most one of mp, mv and mm can be a multiple of 5 */
+			if (mv % 5 == 0)        vr_trailing_zeros = ryu_multiple_of_power_of_5(mv, q);
+			else if (accept_bounds) vm_trailing_zeros = ryu_multiple_of_power_of_5(mm, q);
+			else                    vp -= ryu_multiple_of_power_of_5(mp, q);
+		}
+	} else {
+		u32 q = ((u32)-e2 * 732923) >> 20;
+		s32 i = -e2 - (s32)q;
+		s32 j = (s32)q - ((s32)ryu_pow5_bits(i) - RYU_F32_POW5_BITCOUNT);
+		e10 = (s32)q + e2;
+		vr  = ryu_mul_shift_u32(mv, ryu_f32_pow5_split[i], j);
+		vp  = ryu_mul_shift_u32(mp, ryu_f32_pow5_split[i], j);
+		vm  = ryu_mul_shift_u32(mm, ryu_f32_pow5_split[i], j);
+		if (q != 0 && (vp - 1) / 10 <= vm / 10) {
+			j = (s32)q - 1 - ((s32)ryu_pow5_bits(i + 1) - RYU_F32_POW5_BITCOUNT);
+			last_removed_digit = ryu_mul_shift_u32(mv, ryu_f32_pow5_split[i + 1], j) % 10;
+		}
+		if (q <= 1) {
+			/* NOTE: mv = 4 * m2 always has 2 trailing zero bits */
+			vr_trailing_zeros = 1;
+			if (accept_bounds) vm_trailing_zeros = mm_shift == 1;
+			else               vp--;
+		} else if (q < 31) {
+			vr_trailing_zeros = (mv & ((1u << (q - 1)) - 1)) == 0;
+		}
+	}
+
+	s32 removed = 0;
+	u32 output;
+	if (vm_trailing_zeros || vr_trailing_zeros) {
+		/* NOTE: rare general case */
+		for (; vp / 10 > vm / 10; removed++) {
+			vm_trailing_zeros &= vm % 10 == 0;
+			vr_trailing_zeros &= last_removed_digit == 0;
+			last_removed_digit = vr % 10;
+			vr /= 10; vp /= 10; vm /= 10;
+		}
+		if (vm_trailing_zeros) {
+			for (; vm % 10 == 0; removed++) {
+				vr_trailing_zeros &= last_removed_digit == 0;
+				last_removed_digit = vr % 10;
+				vr /= 10; vp /= 10; vm /= 10;
+			}
+		}
+		/* NOTE: round to even if the exact value is ...50..0 */
+		if (vr_trailing_zeros && last_removed_digit == 5 && vr % 2 == 0)
+			last_removed_digit = 4;
+		output = vr + ((vr == vm && (!accept_bounds || !vm_trailing_zeros)) || last_removed_digit >= 5);
+	} else {
+		for (; vp / 10 > vm / 10; removed++) {
+			last_removed_digit = vr % 10;
+			vr /= 10; vp /= 10; vm /= 10;
+		}
+		output = vr + (vr == vm || last_removed_digit >= 5);
+	}
+
+	*mantissa = output;
+	*exponent = e10 + removed;
+}
+
+/* NOTE: shortest string which parses back to exactly f. Plain notation is used for
+ * reasonable magnitudes (0.53, 120, 0.00012) and scientific otherwise (1.5e-07). */
+function void
+stream_append_f32_shortest(Stream *s, f32 f)
+{
+	u32 bits;
+	memory_copy(&bits, &f, sizeof(bits));
+
+	u8  buf[32];
+	u8 *end = buf + countof(buf);
+	u8 *out = buf;
+	if (bits >> 31) *out++ = '-';
+
+	u32 ieee_mantissa = bits & ((1u << 23) - 1);
+	u32 ieee_exponent = (bits >> 23) & 0xFF;
+	if (ieee_exponent == 0xFF) {
+		str8 special = ieee_mantissa ? str8("nan") : str8("inf");
+		if (ieee_mantissa) out = buf;
+		memory_copy(out, special.data, special.length);
+		out += special.length;
+	} else if (ieee_exponent == 0 && ieee_mantissa == 0) {
+		*out++ = '0';
+	} else {
+		u32 m;
+		s32 e;
+		ryu_f32_decimal(bits, &m, &e);
+
+		u8 *digits  = write_u64_backwards(end, m);
+		s32 length  = (s32)(end - digits);
+		s32 point   = length + e;
+		if (e >= 0 && point <= 9) {
+			memory_copy(out, digits, length);
+			out += length;
+			for (s32 i = 0; i < e; i++) *out++ = '0';
+		} else if (point > 0 && point <= 9) {
+			memory_copy(out, digits, point);
+			out   += point;
+			*out++ = '.';
+			memory_copy(out, digits + point, length - point);
+			out   += length - point;
+		} else if (point <= 0 && point > -5) {
+			*out++ = '0';
+			*out++ = '.';
+			for (s32 i = point; i < 0; i++) *out++ = '0';
+			memory_copy(out, digits, length);
+			out += length;
+		} else {
+			*out++ = digits[0];
+			if (length > 1) {
+				*out++ = '.';
+				memory_copy(out, digits + 1, length - 1);
+				out += length - 1;
+			}
+			s32 exponent = point - 1;
+			*out++ = 'e';
+			*out++ = exponent < 0 ? '-' : '+';
+			exponent = Abs(exponent);
+			*out++ = decimal_digit_pairs[2 * exponent + 0];
+			*out++ = decimal_digit_pairs[2 * exponent + 1];
+		}
+	}
+	stream_append(s, buf, out - buf);
+}
+
+/* NOTE: fixed notation with log10(prec) fractional digits (prec = 100 -> 0.53), correctly
+ * rounded (half to even) from the exact binary value */
 function void
 stream_append_f64(Stream *s, f64 f, s64 prec)
 {
-	if (f < 0) {
-		stream_append_byte(s, '-');
-		f *= -1;
+	assert(prec > 0);
+	u64 bits;
+	memory_copy(&bits, &f, sizeof(bits));
+
+	u64 ieee_mantissa = bits & ((1ull << 52) - 1);
+	u64 ieee_exponent = (bits >> 52) & 0x7FF;
+
+	if (ieee_exponent == 0x7FF && ieee_mantissa) {
+		stream_append_str8(s, str8("nan"));
+		return;
 	}
 
-	/* NOTE: round last digit */
-	f += 0.5f / prec;
+	if (f < 0) stream_append_byte(s, '-');
 
-	if (f >= (f64)(-1UL >> 1)) {
+	if (ieee_exponent == 0x7FF) {
 		stream_append_str8(s, str8("inf"));
+		return;
+	}
+
+	s32 fraction_digits = 0;
+	for (s64 p = prec; p > 1; p /= 10) fraction_digits++;
+
+	u64 m  = ieee_exponent ? (ieee_mantissa | (1ull << 52)) : ieee_mantissa;
+	s32 e2 = ieee_exponent ? (s32)ieee_exponent - 1075 : -1074;
+
+	/* NOTE: N = round(m * 2^e2 * prec); m * prec < 2^117 so it is exact in 128 bits */
+	u128 x     = mul_u64(m, (u64)prec);
+	b32  fits  = 0;
+	u64  n     = 0;
+	if (e2 <= 0) {
+		u32 shift = (u32)-e2;
+		if (shift >= 128) {
+			fits = 1;
+		} else {
+			u64 q_lo, q_hi, r_hi, r_lo, h_hi, h_lo;
+			if (shift == 0) {
+				q_lo = x.lo; q_hi = x.hi; r_lo = r_hi = h_lo = h_hi = 0;
+			} else if (shift < 64) {
+				q_lo = (x.lo >> shift) | (x.hi << (64 - shift));
+				q_hi = x.hi >> shift;
+				r_lo = x.lo & ((1ull << shift) - 1); r_hi = 0;
+				h_lo = 1ull << (shift - 1);          h_hi = 0;
+			} else {
+				q_lo = shift == 64 ? x.hi : x.hi >> (shift - 64);
+				q_hi = 0;
+				r_lo = x.lo;
+				r_hi = shift == 64 ? 0 : x.hi & ((1ull << (shift - 64)) - 1);
+				h_lo = shift == 64 ? 1ull << 63 : 0;
+				h_hi = shift == 64 ? 0 : 1ull << (shift - 65);
+			}
+			b32 above = r_hi > h_hi || (r_hi == h_hi && r_lo > h_lo);
+			b32 half  = r_hi == h_hi && r_lo == h_lo && (shift != 0);
+			if (above || (half && (q_lo & 1))) {
+				if (++q_lo == 0) q_hi++;
+			}
+			fits = q_hi == 0;
+			n    = q_lo;
+		}
 	} else {
-		u64 integral = f;
-		u64 fraction = (f - integral) * prec;
+		fits = x.hi == 0 && e2 < 64 && (x.lo >> (63 - e2)) == 0;
+		if (fits) n = x.lo << e2;
+	}
+
+	if (fits) {
+		u64 integral = n / (u64)prec;
+		u64 fraction = n % (u64)prec;
 		stream_append_u64(s, integral);
-		stream_append_byte(s, '.');
-		for (u64 i = prec / 10; i > 1; i /= 10) {
-			if (i > fraction)
-				stream_append_byte(s, '0');
+		if (fraction_digits) {
+			stream_append_byte(s, '.');
+			stream_append_u64_width(s, fraction, fraction_digits);
+		}
+	} else {
+		/* NOTE: too large for 64 bits; expand the exact decimal value instead */
+		Decimal decimal = {0};
+		u8  tmp[32];
+		u8 *end = tmp + countof(tmp);
+		u8 *beg = write_u64_backwards(end, m);
+		for (; beg < end; beg++) decimal.digits[decimal.count++] = *beg - '0';
+		decimal.point = decimal.count;
+		decimal_trim(&decimal);
+		decimal_shift(&decimal, e2);
+		decimal_round(&decimal, decimal.point + fraction_digits);
+
+		s32 point = Max(decimal.point, 1);
+		for (s32 i = 0; i < point + fraction_digits; i++) {
+			if (i == point) stream_append_byte(s, '.');
+			s32 index = i - (point - decimal.point);
+			u8  digit = Between(index, 0, decimal.count - 1) ? decimal.digits[index] : 0;
+			stream_append_byte(s, '0' + digit);
 		}
-		stream_append_u64(s, fraction);
 	}
 }
 
 function void
 stream_append_colour(Stream *s, Color c)
 {
-	stream_append_hex_u64(s, c.r);
-	stream_append_hex_u64(s, c.g);
-	stream_append_hex_u64(s, c.b);
-	stream_append_hex_u64(s, c.a);
+	stream_append_hex_u32(s, pack_rl_colour(c));
 }
 
 #endif /* _UTIL_C_ */